@@ -0,0 +1,173 @@
+/*
+ * benchmark.cpp
+ *
+ * Compares the tp1 algorithms side by side, exporting the results to <prefix>.csv and <prefix>.json.
+ * Every recursive/dynamic pair is swept over its input sizes, and the size from which the dynamic version
+ * (or calcSum2, for calcSum) is always faster is reported.
+ * Usage: CAL_FP01_benchmark [prefix] [max size] [measurements]
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "src/Benchmark.h"
+#include "src/Factorial.h"
+#include "src/Partitioning.h"
+#include "src/Sum.h"
+
+using namespace std;
+
+/*
+ * Every heap allocation of the program goes through here, so that measure can report allocations per call.
+ */
+static atomic<long long> allocations(0);
+
+static long long countAllocations() {
+	return allocations.load(memory_order_relaxed);
+}
+
+void *operator new(size_t size) {
+	allocations.fetch_add(1, memory_order_relaxed);
+	void *p = malloc(size > 0 ? size : 1);
+	if (p == nullptr)
+		throw bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) noexcept {
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+	free(p);
+}
+
+/*
+ * calcSum is O(n^3), past this size it would take the whole run by itself.
+ */
+static const int CUBIC_MAX_SIZE = 2048;
+
+static const int WARMUPS = 3;
+
+/*
+ * The recursive and dynamic versions return int: the sizes stop where the results still fit in one.
+ */
+static const int FACTORIAL_MAX_N = 12;
+static const int STIRLING_MAX_N = 15;
+static const int BELL_MAX_N = 15;
+
+static void benchmarkFactorial(BenchmarkReport &report, int measurements) {
+	volatile int sink = 0;
+
+	for (int n = 1; n <= FACTORIAL_MAX_N; n++) {
+		report.add(measure("factorialRecurs", n, [&]() { sink += factorialRecurs(n); }, WARMUPS, measurements));
+		report.add(measure("factorialDinam", n, [&]() { sink += factorialDinam(n); }, WARMUPS, measurements));
+	}
+}
+
+/*
+ * S(n, k) is measured at k = n / 2, where the recursion branches the most.
+ */
+static void benchmarkPartitioning(BenchmarkReport &report, int measurements) {
+	volatile int sink = 0;
+
+	for (int n = 2; n <= STIRLING_MAX_N; n++) {
+		int k = n / 2;
+		report.add(measure("s_recursive", n, [&]() { sink += s_recursive(n, k); }, WARMUPS, measurements));
+		report.add(measure("s_dynamic", n, [&]() { sink += s_dynamic(n, k); }, WARMUPS, measurements));
+	}
+
+	for (int n = 1; n <= BELL_MAX_N; n++) {
+		report.add(measure("b_recursive", n, [&]() { sink += b_recursive(n); }, WARMUPS, measurements));
+		report.add(measure("b_dynamic", n, [&]() { sink += b_dynamic(n); }, WARMUPS, measurements));
+	}
+}
+
+/*
+ * Square matrices of side 32 up to sqrt(maxSize) * 4, single and multi-threaded.
+ */
+static void benchmarkSum2D(BenchmarkReport &report, int maxSize, int measurements) {
+	int numThreads = max(1u, thread::hardware_concurrency());
+	volatile size_t sink = 0;
+	vector<MinWindow2D> result;
+
+	for (int side = 32; side * side <= 16 * maxSize; side *= 2) {
+		vector<int> matrix(side * side);
+		for (int &v : matrix)
+			v = rand() % 201 - 100;
+
+		report.add(measure("calcSum2D", (long long) side * side, [&]() { calcSum2D(matrix.data(), side, side, result); sink += result.size(); }, WARMUPS, measurements));
+		report.add(measure("calcSum2D(threads)", (long long) side * side, [&]() { calcSum2D(matrix.data(), side, side, result, numThreads); sink += result.size(); }, WARMUPS, measurements));
+	}
+}
+
+static void printCrossover(const BenchmarkReport &report, const string &slow, const string &fast) {
+	long long size = report.crossover(slow, fast);
+	cout << fast << " beats " << slow;
+	if (size < 0)
+		cout << " at no measured size" << endl;
+	else
+		cout << " from size " << size << " on" << endl;
+}
+
+static void benchmarkSum(BenchmarkReport &report, int maxSize, int measurements) {
+	int numThreads = max(1u, thread::hardware_concurrency());
+	volatile size_t sink = 0; // keeps the compiler from discarding the results
+
+	srand(42);
+
+	for (int size = 16; size <= maxSize; size *= 2) {
+		vector<int> arr(size);
+		for (int &v : arr)
+			v = rand() % size + 1;
+
+		if (size <= CUBIC_MAX_SIZE)
+			report.add(measure("calcSum", size, [&]() { sink += calcSum(arr.data(), size).size(); }, WARMUPS, measurements));
+		report.add(measure("calcSum2", size, [&]() { sink += calcSum2(arr.data(), size).size(); }, WARMUPS, measurements));
+		report.add(measure("calcSumPrefix", size, [&]() { sink += calcSumPrefix(arr.data(), size).size(); }, WARMUPS, measurements));
+		report.add(measure("calcSumParallel", size, [&]() { sink += calcSumParallel(arr.data(), size, numThreads).size(); }, WARMUPS, measurements));
+
+		// values small enough for every window to fit in 16 bits, as int and as int16_t
+		vector<int> small(size);
+		for (int &v : small)
+			v = rand() % 7 - 3;
+		vector<int16_t> small16(small.begin(), small.end());
+		vector<pair<int, int>> pairs;
+		vector<pair<int32_t, int>> pairs16;
+
+		report.add(measure("calcSumPairs(int)", size, [&]() { calcSum(small.data(), size, pairs); sink += pairs.size(); }, WARMUPS, measurements));
+		report.add(measure("calcSumPairs(int16)", size, [&]() { calcSum((const int16_t *) small16.data(), size, pairs16); sink += pairs16.size(); }, WARMUPS, measurements));
+	}
+}
+
+int main(int argc, char *argv[]) {
+	string prefix = argc > 1 ? argv[1] : "bench_tp1";
+	int maxSize = argc > 2 ? atoi(argv[2]) : 16384;
+	int measurements = argc > 3 ? atoi(argv[3]) : 30;
+
+	setAllocationCounter(countAllocations);
+
+	BenchmarkReport report;
+	benchmarkFactorial(report, measurements);
+	benchmarkPartitioning(report, measurements);
+	benchmarkSum(report, maxSize, measurements);
+	benchmarkSum2D(report, maxSize, measurements);
+
+	report.print(cout);
+	cout << endl;
+	printCrossover(report, "factorialRecurs", "factorialDinam");
+	printCrossover(report, "s_recursive", "s_dynamic");
+	printCrossover(report, "b_recursive", "b_dynamic");
+	printCrossover(report, "calcSum", "calcSum2");
+
+	if (!report.writeCsv(prefix + ".csv") || !report.writeJson(prefix + ".json")) {
+		cerr << "Could not write " << prefix << ".csv/.json" << endl;
+		return 1;
+	}
+
+	return 0;
+}
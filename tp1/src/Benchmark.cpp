@@ -0,0 +1,161 @@
+/*
+ * Benchmark.cpp
+ */
+
+#include "Benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+/*
+ * Where measure reads the number of allocations so far, if anywhere.
+ */
+static long long (*allocationCounter)() = nullptr;
+
+/*
+ * Nearest-rank percentile of already sorted samples.
+ */
+static double percentile(const vector<long long> &sorted, double fraction) {
+	size_t rank = (size_t) ceil(fraction * sorted.size());
+	if (rank == 0)
+		rank = 1;
+	return sorted[min(rank, sorted.size()) - 1];
+}
+
+BenchmarkResult summarize(const string &name, long long size, vector<long long> samples) {
+	BenchmarkResult result = {name, size, (int) samples.size(), 0, 0, 0, 0, 0, 0, -1};
+
+	if (samples.empty())
+		return result;
+
+	sort(samples.begin(), samples.end());
+
+	double total = 0;
+	for (long long sample : samples)
+		total += sample;
+
+	result.min = samples.front();
+	result.mean = total / samples.size();
+	result.median = samples.size() % 2 == 1
+			? samples[samples.size() / 2]
+			: (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2.0;
+	result.p95 = percentile(samples, 0.95);
+	result.p99 = percentile(samples, 0.99);
+	result.throughput = result.median > 0 ? size * 1e9 / result.median : 0;
+
+	return result;
+}
+
+void setAllocationCounter(long long (*counter)()) {
+	allocationCounter = counter;
+}
+
+BenchmarkResult measure(const string &name, long long size, const function<void()> &run, int warmups, int measurements) {
+	for (int i = 0; i < warmups; ++i)
+		run();
+
+	vector<long long> samples;
+	samples.reserve(measurements);
+
+	long long allocationsBefore = allocationCounter != nullptr ? allocationCounter() : 0;
+
+	for (int i = 0; i < measurements; ++i) {
+		auto start = chrono::steady_clock::now();
+		run();
+		auto finish = chrono::steady_clock::now();
+		samples.push_back(chrono::duration_cast<chrono::nanoseconds>(finish - start).count());
+	}
+
+	long long allocationsAfter = allocationCounter != nullptr ? allocationCounter() : 0;
+
+	BenchmarkResult result = summarize(name, size, samples);
+	if (allocationCounter != nullptr && measurements > 0)
+		result.allocations = (double) (allocationsAfter - allocationsBefore) / measurements;
+	return result;
+}
+
+void BenchmarkReport::add(const BenchmarkResult &result) {
+	results.push_back(result);
+}
+
+const vector<BenchmarkResult> &BenchmarkReport::getResults() const {
+	return results;
+}
+
+bool BenchmarkReport::writeCsv(const string &fileName) const {
+	ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	file << "Name,Size,Measurements,Min (ns),Mean (ns),Median (ns),P95 (ns),P99 (ns),Throughput (elements/s),Allocations per call\n";
+	file << fixed << setprecision(1);
+	for (const BenchmarkResult &r : results)
+		file << r.name << "," << r.size << "," << r.measurements << "," << r.min << "," << r.mean << ","
+			 << r.median << "," << r.p95 << "," << r.p99 << "," << r.throughput << "," << r.allocations << "\n";
+
+	return file.good();
+}
+
+bool BenchmarkReport::writeJson(const string &fileName) const {
+	ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	file << "[\n" << fixed << setprecision(1);
+	for (size_t i = 0; i < results.size(); ++i) {
+		const BenchmarkResult &r = results[i];
+		file << "  {\"name\": \"" << r.name << "\", \"size\": " << r.size << ", \"measurements\": " << r.measurements
+			 << ", \"min_ns\": " << r.min << ", \"mean_ns\": " << r.mean << ", \"median_ns\": " << r.median
+			 << ", \"p95_ns\": " << r.p95 << ", \"p99_ns\": " << r.p99 << ", \"throughput\": " << r.throughput
+			 << ", \"allocations\": " << r.allocations << "}"
+			 << (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	file << "]\n";
+
+	return file.good();
+}
+
+long long BenchmarkReport::crossover(const string &slow, const string &fast) const {
+	map<long long, double> slowMedians, fastMedians;
+	for (const BenchmarkResult &r : results) {
+		if (r.name == slow)
+			slowMedians[r.size] = r.median;
+		else if (r.name == fast)
+			fastMedians[r.size] = r.median;
+	}
+
+	// walking down from the biggest size, while fast keeps winning
+	long long res = -1;
+	for (auto it = fastMedians.rbegin(); it != fastMedians.rend(); ++it) {
+		auto other = slowMedians.find(it->first);
+		if (other == slowMedians.end())
+			continue;
+		if (it->second >= other->second)
+			break;
+		res = it->first;
+	}
+
+	return res;
+}
+
+void BenchmarkReport::print(ostream &out) const {
+	ios::fmtflags flags = out.flags();
+
+	out << left << setw(24) << "name" << right << setw(10) << "size" << setw(14) << "median (ns)"
+		<< setw(14) << "p95 (ns)" << setw(14) << "p99 (ns)" << setw(16) << "elements/s" << setw(14) << "allocs/call" << "\n";
+	out << fixed << setprecision(0);
+	for (const BenchmarkResult &r : results) {
+		out << left << setw(24) << r.name << right << setw(10) << r.size << setw(14) << r.median
+			<< setw(14) << r.p95 << setw(14) << r.p99 << setw(16) << r.throughput;
+		if (r.allocations >= 0)
+			out << setw(14) << setprecision(1) << r.allocations << setprecision(0);
+		else
+			out << setw(14) << "-";
+		out << "\n";
+	}
+
+	out.flags(flags);
+}
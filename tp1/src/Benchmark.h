@@ -0,0 +1,73 @@
+/*
+ * Benchmark.h
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+/* Resultado das medições de um algoritmo para um dado tamanho de entrada.
+ * Os tempos estão em nanossegundos e o throughput em elementos da entrada por segundo (calculado com a mediana).
+ * allocations é o número médio de alocações no heap por chamada (-1 se não houver contador, ver setAllocationCounter).
+ */
+struct BenchmarkResult {
+	string name;
+	long long size;
+	int measurements;
+	double min;
+	double mean;
+	double median;
+	double p95;
+	double p99;
+	double throughput;
+	double allocations;
+};
+
+/* Calcula as estatísticas de um conjunto de tempos (em nanossegundos), já medidos.
+ * Os percentis usam o método do rank mais próximo.
+ */
+BenchmarkResult summarize(const string &name, long long size, vector<long long> samples);
+
+/* Mede a função run com um steady_clock (resolução de nanossegundos).
+ * Faz primeiro warmups execuções que não contam e depois measurements execuções cronometradas, uma a uma.
+ * A preparação da entrada deve ser feita fora de run, para não ser cronometrada.
+ */
+BenchmarkResult measure(const string &name, long long size, const function<void()> &run, int warmups = 3, int measurements = 30);
+
+/* Indica a measure como saber quantas alocações no heap já foram feitas (por exemplo, um contador incrementado
+ * por um operator new substituído pelo programa de benchmark). Com nullptr, as alocações deixam de ser contadas.
+ */
+void setAllocationCounter(long long (*counter)());
+
+/*
+ * Conjunto de resultados que podem ser comparados lado a lado e exportados, para seguir regressões entre builds.
+ */
+class BenchmarkReport {
+	vector<BenchmarkResult> results;
+
+public:
+	void add(const BenchmarkResult &result);
+
+	const vector<BenchmarkResult> &getResults() const;
+
+	/* Exporta um csv com uma linha por resultado. Devolve false se não conseguir escrever o ficheiro. */
+	bool writeCsv(const string &fileName) const;
+
+	/* Exporta os mesmos dados em json: um array de objetos, um por resultado. */
+	bool writeJson(const string &fileName) const;
+
+	/* Ponto de viragem entre duas implementações do mesmo algoritmo: o menor tamanho a partir do qual a mediana de fast
+	 * é sempre menor do que a de slow (nos tamanhos medidos para as duas). Devolve -1 se fast nunca passar à frente.
+	 */
+	long long crossover(const string &slow, const string &fast) const;
+
+	/* Imprime uma tabela legível com os resultados. */
+	void print(ostream &out) const;
+};
+
+#endif /* BENCHMARK_H_ */
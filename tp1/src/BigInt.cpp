@@ -0,0 +1,325 @@
+/*
+ * BigInt.cpp
+ */
+
+#include "BigInt.h"
+#include "Format.h"
+#include "Ntt.h"
+#include <algorithm>
+#include <thread>
+
+/*
+ * Below this many limbs (in the smaller operand) Karatsuba isn't worth it.
+ */
+static const size_t KARATSUBA_THRESHOLD = 40;
+
+/*
+ * From this many limbs on, the product is done with number theoretic transforms, in O(n log n).
+ * The transforms modulo NTT_MOD_A have at most 2^23 points.
+ */
+static const size_t NTT_THRESHOLD = 1500;
+static const size_t NTT_MAX_SIZE = (size_t) 1 << 23;
+
+BigInt::BigInt(unsigned long long value) {
+	while (value > 0) {
+		limbs.push_back((uint32_t) (value % BASE));
+		value /= BASE;
+	}
+}
+
+BigInt::BigInt(const string &decimal) {
+	for (long long end = decimal.size(); end > 0; end -= BASE_DIGITS) {
+		long long start = max(0LL, end - BASE_DIGITS);
+		limbs.push_back((uint32_t) stoul(decimal.substr(start, end - start)));
+	}
+	trim();
+}
+
+void BigInt::trim() {
+	while (!limbs.empty() && limbs.back() == 0)
+		limbs.pop_back();
+}
+
+bool BigInt::isZero() const {
+	return limbs.empty();
+}
+
+size_t BigInt::numDigits() const {
+	if (limbs.empty())
+		return 1;
+	return (limbs.size() - 1) * BASE_DIGITS + intLength(limbs.back());
+}
+
+uint32_t BigInt::mod(uint32_t m) const {
+	uint64_t rest = 0;
+	for (size_t i = limbs.size(); i-- > 0;)
+		rest = (rest * BASE + limbs[i]) % m;
+	return (uint32_t) rest;
+}
+
+BigInt &BigInt::operator+=(const BigInt &other) {
+	if (other.limbs.size() > limbs.size())
+		limbs.resize(other.limbs.size(), 0);
+
+	uint32_t carry = 0;
+	for (size_t i = 0; i < limbs.size() && (carry || i < other.limbs.size()); i++) {
+		uint32_t sum = limbs[i] + carry + (i < other.limbs.size() ? other.limbs[i] : 0);
+		carry = sum >= BASE;
+		limbs[i] = carry ? sum - BASE : sum;
+	}
+	if (carry)
+		limbs.push_back(carry);
+
+	return *this;
+}
+
+BigInt BigInt::operator+(const BigInt &other) const {
+	BigInt res = *this;
+	res += other;
+	return res;
+}
+
+BigInt &BigInt::operator*=(uint32_t factor) {
+	uint64_t carry = 0;
+	for (uint32_t &limb : limbs) {
+		uint64_t cur = (uint64_t) limb * factor + carry;
+		limb = (uint32_t) (cur % BASE);
+		carry = cur / BASE;
+	}
+	while (carry > 0) {
+		limbs.push_back((uint32_t) (carry % BASE));
+		carry /= BASE;
+	}
+	trim();
+	return *this;
+}
+
+/*
+ * Low level helpers over raw limb arrays, all in base 10^9.
+ */
+
+// res[0 .. na + nb) = a * b, res must start zeroed
+static void mulSchoolbook(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *res) {
+	for (size_t i = 0; i < na; i++) {
+		uint64_t carry = 0;
+		uint64_t ai = a[i];
+		if (ai == 0)
+			continue;
+		for (size_t j = 0; j < nb; j++) {
+			uint64_t cur = res[i + j] + ai * b[j] + carry;
+			res[i + j] = (uint32_t) (cur % BigInt::BASE);
+			carry = cur / BigInt::BASE;
+		}
+		for (size_t k = i + nb; carry > 0; k++) {
+			uint64_t cur = res[k] + carry;
+			res[k] = (uint32_t) (cur % BigInt::BASE);
+			carry = cur / BigInt::BASE;
+		}
+	}
+}
+
+// res[0 .. max(na, nb) + 1) = a + b
+static void addLimbs(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *res) {
+	uint32_t carry = 0;
+	for (size_t i = 0; i < max(na, nb); i++) {
+		uint32_t sum = carry + (i < na ? a[i] : 0) + (i < nb ? b[i] : 0);
+		carry = sum >= BigInt::BASE;
+		res[i] = carry ? sum - BigInt::BASE : sum;
+	}
+	res[max(na, nb)] = carry;
+}
+
+// a[0 .. na) -= b[0 .. nb), a >= b
+static void subLimbs(uint32_t *a, size_t na, const uint32_t *b, size_t nb) {
+	uint32_t borrow = 0;
+	for (size_t i = 0; i < na && (borrow || i < nb); i++) {
+		uint32_t sub = borrow + (i < nb ? b[i] : 0);
+		borrow = a[i] < sub;
+		a[i] = borrow ? a[i] + BigInt::BASE - sub : a[i] - sub;
+	}
+}
+
+// a[0 ..) += b[0 .. nb), a has room for the carry
+static void addInto(uint32_t *a, const uint32_t *b, size_t nb) {
+	uint32_t carry = 0;
+	size_t i = 0;
+	for (; i < nb; i++) {
+		uint32_t sum = a[i] + b[i] + carry;
+		carry = sum >= BigInt::BASE;
+		a[i] = carry ? sum - BigInt::BASE : sum;
+	}
+	for (; carry; i++) {
+		uint32_t sum = a[i] + carry;
+		carry = sum >= BigInt::BASE;
+		a[i] = carry ? sum - BigInt::BASE : sum;
+	}
+}
+
+/*
+ * res[0 .. na + nb) = a * b with three convolutions, modulo three NTT primes (in parallel, given the threads),
+ * put back together with the chinese remainder theorem. Each coefficient of the exact convolution is below
+ * nb * BASE^2 < 2^23 * 10^18, less than the product of the primes (~7.8 * 10^25), so it is recovered exactly.
+ */
+static void mulNtt(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *res, int numThreads) {
+	vector<uint32_t> va(a, a + na), vb(b, b + nb);
+	vector<uint32_t> c1, c2, c3;
+
+	if (numThreads >= 3) {
+		thread t1([&]() { c1 = convolution<NTT_MOD_A>(va, vb); });
+		thread t2([&]() { c2 = convolution<NTT_MOD_B>(va, vb); });
+		c3 = convolution<NTT_MOD_C>(va, vb);
+		t1.join();
+		t2.join();
+	} else if (numThreads == 2) {
+		thread t1([&]() { c1 = convolution<NTT_MOD_A>(va, vb); });
+		c2 = convolution<NTT_MOD_B>(va, vb);
+		t1.join();
+		c3 = convolution<NTT_MOD_C>(va, vb);
+	} else {
+		c1 = convolution<NTT_MOD_A>(va, vb);
+		c2 = convolution<NTT_MOD_B>(va, vb);
+		c3 = convolution<NTT_MOD_C>(va, vb);
+	}
+
+	unsigned __int128 carry = 0;
+	for (size_t k = 0; k < na + nb; k++) {
+		if (k < c1.size())
+			carry += crt(c1[k], c2[k], c3[k]);
+		res[k] = (uint32_t) (carry % BigInt::BASE);
+		carry /= BigInt::BASE;
+	}
+}
+
+/*
+ * res[0 .. na + nb) = a * b, res zeroed, na >= nb.
+ * Karatsuba: with a = a1 B^h + a0 and b = b1 B^h + b0,
+ * 		a b = z2 B^2h + (z1 - z2 - z0) B^h + z0, z0 = a0 b0, z2 = a1 b1, z1 = (a0 + a1)(b0 + b1).
+ * When there are threads to spare, z0 and z2 are computed in parallel with z1.
+ */
+static void mulKaratsuba(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *res, int numThreads) {
+	if (nb < KARATSUBA_THRESHOLD) {
+		mulSchoolbook(a, na, b, nb, res);
+		return;
+	}
+
+	if (nb >= NTT_THRESHOLD && na + nb <= NTT_MAX_SIZE) {
+		mulNtt(a, na, b, nb, res, numThreads);
+		return;
+	}
+
+	size_t h = na / 2;
+	if (nb <= h) {
+		// very unbalanced: split only a, in two products with b
+		vector<uint32_t> high(na - h + nb, 0);
+		if (numThreads > 1) {
+			thread t([&]() { mulKaratsuba(a, h, b, nb, res, numThreads / 2); });
+			mulKaratsuba(a + h, na - h, b, nb, high.data(), numThreads - numThreads / 2);
+			t.join();
+		} else {
+			mulKaratsuba(a + h, na - h, b, nb, high.data(), 1);
+			mulKaratsuba(a, h, b, nb, res, 1);
+		}
+		addInto(res + h, high.data(), high.size());
+		return;
+	}
+
+	const uint32_t *a0 = a, *a1 = a + h, *b0 = b, *b1 = b + h;
+	size_t na1 = na - h, nb1 = nb - h;
+
+	vector<uint32_t> sa(na1 + 1), sb(na1 + 1, 0);
+	addLimbs(a0, h, a1, na1, sa.data());
+	addLimbs(b0, h, b1, nb1, sb.data());
+	size_t nsa = sa.size(), nsb = sb.size();
+	while (nsa > 0 && sa[nsa - 1] == 0) nsa--;
+	while (nsb > 0 && sb[nsb - 1] == 0) nsb--;
+
+	vector<uint32_t> z1(nsa + nsb + 1, 0);
+	uint32_t *z0 = res;          // a0 b0 goes straight to the low part
+	uint32_t *z2 = res + 2 * h;  // and a1 b1 to the high part, they don't overlap
+
+	auto mulZ1 = [&](int threads) {
+		if (nsa >= nsb)
+			mulKaratsuba(sa.data(), nsa, sb.data(), nsb, z1.data(), threads);
+		else
+			mulKaratsuba(sb.data(), nsb, sa.data(), nsa, z1.data(), threads);
+	};
+
+	if (numThreads >= 3) {
+		thread t0([&]() { mulKaratsuba(a0, h, b0, h, z0, numThreads / 3); });
+		thread t2([&]() { mulKaratsuba(a1, na1, b1, nb1, z2, numThreads / 3); });
+		mulZ1(numThreads - 2 * (numThreads / 3));
+		t0.join();
+		t2.join();
+	} else if (numThreads == 2) {
+		thread t0([&]() { mulKaratsuba(a0, h, b0, h, z0, 1); });
+		mulKaratsuba(a1, na1, b1, nb1, z2, 1);
+		t0.join();
+		mulZ1(2);
+	} else {
+		mulKaratsuba(a0, h, b0, h, z0, 1);
+		mulKaratsuba(a1, na1, b1, nb1, z2, 1);
+		mulZ1(1);
+	}
+
+	subLimbs(z1.data(), z1.size(), z0, 2 * h);
+	subLimbs(z1.data(), z1.size(), z2, na1 + nb1);
+
+	size_t nz1 = z1.size();
+	while (nz1 > 0 && z1[nz1 - 1] == 0) nz1--;
+	addInto(res + h, z1.data(), nz1);
+}
+
+BigInt multiply(const BigInt &a, const BigInt &b, int numThreads) {
+	BigInt res;
+	if (a.isZero() || b.isZero())
+		return res;
+
+	const BigInt &big = a.limbs.size() >= b.limbs.size() ? a : b;
+	const BigInt &small = a.limbs.size() >= b.limbs.size() ? b : a;
+
+	res.limbs.assign(a.limbs.size() + b.limbs.size(), 0);
+	mulKaratsuba(big.limbs.data(), big.limbs.size(), small.limbs.data(), small.limbs.size(), res.limbs.data(), max(1, numThreads));
+	res.trim();
+	return res;
+}
+
+BigInt BigInt::operator*(const BigInt &other) const {
+	return multiply(*this, other, 1);
+}
+
+bool BigInt::operator==(const BigInt &other) const {
+	return limbs == other.limbs;
+}
+
+bool BigInt::operator!=(const BigInt &other) const {
+	return limbs != other.limbs;
+}
+
+bool BigInt::operator<(const BigInt &other) const {
+	if (limbs.size() != other.limbs.size())
+		return limbs.size() < other.limbs.size();
+	return lexicographical_compare(limbs.rbegin(), limbs.rend(), other.limbs.rbegin(), other.limbs.rend());
+}
+
+string BigInt::toString() const {
+	if (limbs.empty())
+		return "0";
+
+	string res(numDigits(), '0');
+	char *out = &res[0];
+	out += writeInt(out, limbs.back());
+
+	for (size_t i = limbs.size() - 1; i-- > 0; out += BASE_DIGITS) {
+		uint32_t limb = limbs[i];
+		for (int d = BASE_DIGITS - 1; d >= 0; d--) {
+			out[d] = (char) ('0' + limb % 10);
+			limb /= 10;
+		}
+	}
+
+	return res;
+}
+
+ostream &operator<<(ostream &out, const BigInt &value) {
+	return out << value.toString();
+}
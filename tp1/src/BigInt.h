@@ -0,0 +1,66 @@
+/*
+ * BigInt.h
+ */
+
+#ifndef BIGINT_H_
+#define BIGINT_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+/*
+ * Inteiro não negativo de precisão arbitrária.
+ * Guarda os dígitos em base 10^9 (do menos para o mais significativo), o que torna a escrita em decimal imediata.
+ * A multiplicação usa o algoritmo de Karatsuba para números grandes e transformadas numéricas (NTT) para números
+ * enormes, e pode dividir o trabalho por várias threads.
+ */
+class BigInt {
+	/**
+	 * limbs[i] - dígito i, em base BASE (sem zeros à esquerda; o zero é o vetor vazio)
+	 */
+	vector<uint32_t> limbs;
+
+	void trim();
+
+public:
+	static const uint32_t BASE = 1000000000;
+	static const int BASE_DIGITS = 9;
+
+	BigInt(unsigned long long value = 0);
+
+	/* Lê um número escrito em decimal (só dígitos). */
+	explicit BigInt(const string &decimal);
+
+	bool isZero() const;
+
+	/* Número de dígitos decimais (1 para o zero). */
+	size_t numDigits() const;
+
+	/* Resto da divisão por um número pequeno. */
+	uint32_t mod(uint32_t m) const;
+
+	BigInt &operator+=(const BigInt &other);
+	BigInt operator+(const BigInt &other) const;
+
+	BigInt &operator*=(uint32_t factor);
+	BigInt operator*(const BigInt &other) const;
+
+	/* Multiplica a por b, usando no máximo numThreads threads. */
+	friend BigInt multiply(const BigInt &a, const BigInt &b, int numThreads);
+
+	bool operator==(const BigInt &other) const;
+	bool operator!=(const BigInt &other) const;
+	bool operator<(const BigInt &other) const;
+
+	/* Escreve o número em decimal. */
+	string toString() const;
+
+	friend ostream &operator<<(ostream &out, const BigInt &value);
+};
+
+BigInt multiply(const BigInt &a, const BigInt &b, int numThreads = 1);
+
+#endif /* BIGINT_H_ */
@@ -2,67 +2,523 @@
  * Change.cpp
  */
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
 #include <vector>
 #include "Change.h"
+#include "Format.h"
+#include "Ntt.h"
 
-void clearVectors(int size, int minCoins[], int lastCoin[]);
+/*
+ * minCoins of an amount that can't be formed with the coins.
+ */
+static const int UNREACHABLE = -1;
+
+/*
+ * Biggest amount a ChangeTable stores: the table is indexed by int and keeps two ints per amount.
+ */
+static const long long MAX_TABLE_AMOUNT = numeric_limits<int>::max() / 2;
+
+static bool isCanonicalCached(int numCoins, const int *coinValues);
+
+/*
+ * Greedy change: as many coins of the biggest value as possible, then of the next one and so on.
+ * Calls visit(coin, count) for each coin used, by decreasing value. Returns false if something is left over.
+ */
+template <typename Visitor>
+static bool walkGreedy(long long m, int numCoins, const int *coinValues, Visitor visit) {
+	for (int i = numCoins - 1; i >= 0 && m > 0; i--) {
+		long long count = m / coinValues[i];
+		if (count > 0) {
+			visit(i, count);
+			m -= count * coinValues[i];
+		}
+	}
+	return m == 0;
+}
+
+/*
+ * The output formats, for any way of walking through the coins of a solution (greedy or following the table).
+ * walk(visit) calls visit(coin, count) by decreasing value and returns false if there is no solution.
+ */
+template <typename Walker>
+static void formatChange(const int *coinValues, Walker walk, string &res) {
+	size_t length = 0;
+
+	if (!walk([&](int coin, long long count) { length += (intLength(coinValues[coin]) + 1) * (size_t) count; })) {
+		res = "-";
+		return;
+	}
+
+	res.resize(length);
+	char *out = &res[0];
+	walk([&](int coin, long long count) {
+		for (long long k = 0; k < count; k++) {
+			out += writeInt(out, coinValues[coin]);
+			*out++ = ';';
+		}
+	});
+}
 
-string getDescriptiveString(int m, int *coinValues, int *lastCoin);
+template <typename Walker>
+static size_t formatChange(const int *coinValues, Walker walk, char *buffer, size_t capacity) {
+	size_t length = 0;
+
+	if (!walk([&](int coin, long long count) { length += (intLength(coinValues[coin]) + 1) * (size_t) count; })) {
+		if (capacity >= 1)
+			buffer[0] = '-';
+		return 1;
+	}
+
+	if (length <= capacity)
+		walk([&](int coin, long long count) {
+			for (long long k = 0; k < count; k++) {
+				buffer += writeInt(buffer, coinValues[coin]);
+				*buffer++ = ';';
+			}
+		});
+
+	return length;
+}
+
+template <typename Walker, typename Count>
+static bool tallyCoins(int numCoins, Walker walk, vector<Count> &coinCounts) {
+	coinCounts.assign(numCoins, 0);
+	return walk([&](int coin, long long count) { coinCounts[coin] += (Count) count; });
+}
 
 string calcChange(int m, int numCoins, int *coinValues) {
-	int minCoins[m + 1];
-    int lastCoin[m + 1];
+	string res;
+	calcChange(m, numCoins, coinValues, res);
+	return res;
+}
 
-    int *currentValue = coinValues;
+void calcChange(int m, int numCoins, int *coinValues, string &res) {
+	if (isCanonicalCached(numCoins, coinValues))
+		formatChange(coinValues, [&](auto visit) { return walkGreedy(m, numCoins, coinValues, visit); }, res);
+	else
+		ChangeTable(numCoins, coinValues, m).calcChange(m, res);
+}
 
-	clearVectors(m+1, minCoins, lastCoin);
+size_t calcChange(int m, int numCoins, int *coinValues, char *buffer, size_t capacity) {
+	if (isCanonicalCached(numCoins, coinValues))
+		return formatChange(coinValues, [&](auto visit) { return walkGreedy(m, numCoins, coinValues, visit); }, buffer, capacity);
+	return ChangeTable(numCoins, coinValues, m).calcChange(m, buffer, capacity);
+}
 
-	for (int i = 1; i <= numCoins; ++i) {
-		for (int j = 0; j <= m; j++) {
+bool calcChange(int m, int numCoins, int *coinValues, vector<int> &coinCounts) {
+	if (isCanonicalCached(numCoins, coinValues))
+		return tallyCoins(numCoins, [&](auto visit) { return walkGreedy(m, numCoins, coinValues, visit); }, coinCounts);
+	return ChangeTable(numCoins, coinValues, m).calcChange(m, coinCounts);
+}
 
-			if (j < *currentValue)
-				continue;
+bool calcChange(long long m, int numCoins, int *coinValues, vector<long long> &coinCounts) {
+	if (isCanonicalCached(numCoins, coinValues))
+		return tallyCoins(numCoins, [&](auto visit) { return walkGreedy(m, numCoins, coinValues, visit); }, coinCounts);
+	return ChangeTable(numCoins, coinValues).calcChange(m, coinCounts);
+}
+
+/*
+ * Walks coinCounts as a solution, by decreasing value.
+ */
+template <typename Visitor>
+static bool walkCounts(const vector<int> &coinCounts, Visitor visit) {
+	for (int i = (int) coinCounts.size() - 1; i >= 0; i--)
+		if (coinCounts[i] > 0)
+			visit(i, coinCounts[i]);
+	return true;
+}
 
-			if (minCoins[j - *currentValue] + 1 < minCoins[j] || minCoins[j] == 0) {
-				minCoins[j] = minCoins[j - *currentValue] + 1;
-				lastCoin[j] = i;
+/*
+ * Bounded change making, adding one coin value at a time: with at most L coins of value c,
+ * 		new[j] = min(old[j - k * c] + k), 0 <= k <= L.
+ * For the amounts j = r + t * c with the same remainder r this is
+ * 		new[r + t * c] = t + min(old[r + s * c] - s), t - L <= s <= t,
+ * the minimum of a sliding window, kept in a monotone queue (here a plain array, since each position enters once).
+ * So each coin costs O(m), without expanding it into L copies. taken remembers how many coins of each value
+ * were used for each amount, to rebuild the solution in the end.
+ */
+static bool boundedChange(int m, int numCoins, const int *coinValues, const int *coinLimits, vector<int> &coinCounts) {
+	const int INF = numeric_limits<int>::max() / 2;
+
+	vector<int> best(m + 1, INF), next(m + 1);
+	vector<int> taken((size_t) numCoins * (m + 1));
+	vector<int> queue(m + 1);
+	best[0] = 0;
+
+	for (int i = 0; i < numCoins; i++) {
+		int c = coinValues[i];
+		int limit = coinLimits[i];
+		int *take = &taken[(size_t) i * (m + 1)];
+
+		for (int r = 0; r < c && r <= m; r++) {
+			int head = 0, tail = 0;
+
+			for (int t = 0, j = r; j <= m; t++, j += c) {
+				if (best[j] < INF) {
+					// on ties the older position stays, using more of the (bigger) new coin
+					while (tail > head && best[r + queue[tail - 1] * c] - queue[tail - 1] > best[j] - t)
+						tail--;
+					queue[tail++] = t;
+				}
+				while (head < tail && queue[head] < t - limit)
+					head++;
+
+				if (head < tail) {
+					int s = queue[head];
+					next[j] = best[r + s * c] - s + t;
+					take[j] = t - s;
+				} else {
+					next[j] = INF;
+					take[j] = 0;
+				}
 			}
 		}
 
-		currentValue++;
+		swap(best, next);
+	}
+
+	coinCounts.assign(numCoins, 0);
+	if (best[m] >= INF)
+		return false;
+
+	for (int i = numCoins - 1, j = m; i >= 0; i--) {
+		coinCounts[i] = taken[(size_t) i * (m + 1) + j];
+		j -= coinCounts[i] * coinValues[i];
 	}
 
-	return getDescriptiveString(m, coinValues, lastCoin);
+	return true;
 }
 
-string getDescriptiveString(int m, int *coinValues, int *lastCoin) {
-	vector<int> selectedCoinValues;
+string calcChange(int m, int numCoins, int *coinValues, int *coinLimits) {
+	vector<int> coinCounts;
+	if (!boundedChange(m, numCoins, coinValues, coinLimits, coinCounts))
+		return "-";
 
-	int index = m;
+	string res;
+	formatChange(coinValues, [&](auto visit) { return walkCounts(coinCounts, visit); }, res);
+	return res;
+}
+
+bool calcChange(int m, int numCoins, int *coinValues, int *coinLimits, vector<int> &coinCounts) {
+	return boundedChange(m, numCoins, coinValues, coinLimits, coinCounts);
+}
 
-	while (index > 0) {
-		int selectedCoinIndex = lastCoin[index];
+/*
+ * Pearson's test (D. Pearson, "A polynomial-time algorithm for the change-making problem", 2005), O(n^3).
+ * With the coins by decreasing value c1 > c2 > ... > cn = 1, the smallest amount where greedy isn't optimal,
+ * if there is one, is built from the greedy solution of c(i-1) - 1: keep its coins c1..cj, add one more cj
+ * and drop the smaller ones, for some 1 < i <= j <= n. Each of these O(n^2) candidates is checked with greedy.
+ */
+bool isCanonical(int numCoins, int *coinValues) {
+	if (numCoins == 0 || coinValues[0] != 1)
+		return false; // without a coin of 1 greedy can get stuck on amounts that have change
+
+	vector<long long> coins(coinValues, coinValues + numCoins);
+	reverse(coins.begin(), coins.end());
+
+	vector<long long> greedy(numCoins);
+	auto fillGreedy = [&](long long amount) {
+		long long count = 0;
+		for (int k = 0; k < numCoins; k++) {
+			greedy[k] = amount / coins[k];
+			amount -= greedy[k] * coins[k];
+			count += greedy[k];
+		}
+		return count;
+	};
 
-		if (selectedCoinIndex <= 0) // It is impossible
-			return "-";
+	for (int i = 1; i < numCoins; i++) {
+		for (int j = i; j < numCoins; j++) {
+			fillGreedy(coins[i - 1] - 1);
 
-		int value = coinValues[selectedCoinIndex - 1];
-		selectedCoinValues.push_back(value);
-		index -= value;
+			long long amount = coins[j], count = 1;
+			for (int k = 0; k <= j; k++) {
+				amount += greedy[k] * coins[k];
+				count += greedy[k];
+			}
+
+			if (fillGreedy(amount) > count)
+				return false;
+		}
 	}
 
-	string res;
-	for (int v : selectedCoinValues)
-		res = res + to_string(v) + ";";
+	return true;
+}
+
+/*
+ * Callers usually ask for change many times in a row with the same coins, so each thread remembers
+ * the last coin system it checked and only runs the test again when the coins change.
+ */
+static bool isCanonicalCached(int numCoins, const int *coinValues) {
+	thread_local vector<int> lastCoins;
+	thread_local bool lastCanonical = false;
+
+	if (!lastCoins.empty() && (int) lastCoins.size() == numCoins && equal(lastCoins.begin(), lastCoins.end(), coinValues))
+		return lastCanonical;
+
+	lastCoins.assign(coinValues, coinValues + numCoins);
+	lastCanonical = isCanonical(numCoins, lastCoins.data());
+	return lastCanonical;
+}
+
+/*
+ * Past the threshold the table repeats itself with period c (the biggest coin), one coin more each time.
+ * Some optimal solution has fewer than c coins smaller than c: among any c of them there is a group whose sum
+ * is a multiple of c (pigeonhole on the prefix sums mod c), and it can be swapped for fewer coins of value c.
+ * So above (c - 1) * c' (c' the second biggest coin) every optimal solution can use a coin c, that is,
+ * minCoins[j] = minCoins[j - c] + 1 (and j can't be formed if j - c can't).
+ * Nothing is proven below that bound, so when the table can't reach it the amounts above the table are refused.
+ */
+ChangeTable::ChangeTable(int numCoins, int *coinValues, int maxAmount) : coinValues(coinValues, coinValues + numCoins) {
+	canonical = isCanonicalCached(numCoins, coinValues);
+	minCoins.push_back(0);
+	lastCoin.push_back(0);
+
+	long long biggest = numCoins > 0 ? coinValues[numCoins - 1] : 0;
+	long long second = numCoins > 1 ? coinValues[numCoins - 2] : 0;
+	threshold = (biggest - 1) * second + biggest;
+
+	if (!canonical)
+		extend((int) min((long long) maxAmount, min(threshold, MAX_TABLE_AMOUNT)));
+}
+
+int ChangeTable::getMaxAmount() const {
+	return (int) minCoins.size() - 1;
+}
 
+bool ChangeTable::isCanonical() const {
+	return canonical;
+}
+
+bool ChangeTable::isSupported(long long m) const {
+	return canonical || m <= MAX_TABLE_AMOUNT || threshold <= MAX_TABLE_AMOUNT;
+}
+
+/*
+ * Fills the amounts getMaxAmount() + 1 .. maxAmount, one amount at a time, so the table can keep growing.
+ *
+ * For each amount it keeps the minimum number of coins and, among the solutions with that many coins,
+ * one with the biggest coin possible: lastCoin[j] is that coin (1-based index). Taking it out leaves an
+ * amount whose lastCoin is no bigger, so following lastCoin gives the coins by decreasing value.
+ * When greedy is optimal this is exactly the greedy solution.
+ */
+void ChangeTable::extend(int maxAmount) {
+	int from = getMaxAmount() + 1;
+	if (maxAmount < from)
+		return;
+
+	minCoins.resize(maxAmount + 1);
+	lastCoin.resize(maxAmount + 1);
+
+	for (int j = from; j <= maxAmount; j++) {
+		int bestCount = UNREACHABLE;
+		int bestCoin = 0;
+
+		for (int i = 0; i < (int) coinValues.size() && coinValues[i] <= j; i++) {
+			int rest = j - coinValues[i];
+			if (minCoins[rest] == UNREACHABLE)
+				continue;
+
+			if (bestCount == UNREACHABLE || minCoins[rest] + 1 <= bestCount) {
+				bestCount = minCoins[rest] + 1;
+				bestCoin = i + 1;
+			}
+		}
+
+		minCoins[j] = bestCount;
+		lastCoin[j] = bestCoin;
+	}
+}
+
+/*
+ * Makes sure m is in the table, doubling it so that a sequence of growing queries costs amortized O(1) extensions.
+ */
+void ChangeTable::reserve(int m) {
+	if (m > getMaxAmount())
+		extend((int) min(max((long long) m, 2LL * getMaxAmount()), min(threshold, MAX_TABLE_AMOUNT)));
+}
+
+/*
+ * Writes m as q coins of the biggest value plus an amount inside the table (q = 0 if m is already inside).
+ */
+long long ChangeTable::reduce(long long &m) const {
+	if (m <= threshold || coinValues.empty())
+		return 0;
+
+	long long biggest = coinValues.back();
+	long long q = (m - threshold + biggest - 1) / biggest;
+	m -= q * biggest;
+	return q;
+}
+
+long long ChangeTable::getMinCoins(long long m) {
+	if (canonical) {
+		long long count = 0;
+		walkGreedy(m, (int) coinValues.size(), coinValues.data(), [&](int, long long n) { count += n; });
+		return count;
+	}
+
+	if (!isSupported(m))
+		return UNREACHABLE;
+
+	long long q = reduce(m);
+	reserve((int) m);
+
+	if (minCoins[m] == UNREACHABLE)
+		return UNREACHABLE;
+	return q + minCoins[m];
+}
+
+/*
+ * Calls visit(coin, count) for the coins of the solution of m, by decreasing value: greedily when that is
+ * optimal, otherwise following lastCoin. Returns false if m can't be formed with the coins.
+ */
+template <typename Visitor>
+bool ChangeTable::walkCoins(long long m, Visitor visit) {
+	if (canonical)
+		return walkGreedy(m, (int) coinValues.size(), coinValues.data(), visit);
+
+	if (!isSupported(m))
+		return false;
+
+	long long q = reduce(m);
+	reserve((int) m);
+
+	if (minCoins[m] == UNREACHABLE)
+		return false;
+
+	if (q > 0)
+		visit((int) coinValues.size() - 1, q);
+
+	for (int index = m; index > 0; index -= coinValues[lastCoin[index] - 1])
+		visit(lastCoin[index] - 1, 1);
+
+	return true;
+}
+
+string ChangeTable::calcChange(int m) {
+	string res;
+	calcChange(m, res);
 	return res;
 }
 
-void clearVectors(int size, int minCoins[], int lastCoin[]) {
-	for (int i = 0; i <= size; i++) {
-		minCoins[i] = 0;
-		lastCoin[i] = 0;
+void ChangeTable::calcChange(int m, string &res) {
+	formatChange(coinValues.data(), [&](auto visit) { return walkCoins(m, visit); }, res);
+}
+
+size_t ChangeTable::calcChange(int m, char *buffer, size_t capacity) {
+	return formatChange(coinValues.data(), [&](auto visit) { return walkCoins(m, visit); }, buffer, capacity);
+}
+
+bool ChangeTable::calcChange(int m, vector<int> &coinCounts) {
+	return tallyCoins((int) coinValues.size(), [&](auto visit) { return walkCoins(m, visit); }, coinCounts);
+}
+
+bool ChangeTable::calcChange(long long m, vector<long long> &coinCounts) {
+	return tallyCoins((int) coinValues.size(), [&](auto visit) { return walkCoins(m, visit); }, coinCounts);
+}
+
+/*
+ * countChange uses the rolling DP while its m * numCoins steps are fewer than this many times the
+ * D log D log m of the polynomial method (whose steps are NTT butterflies over three primes, a lot heavier).
+ * The DP table is one int per amount, so it is also capped in size.
+ */
+static const double COUNT_DP_FACTOR = 64;
+static const long long COUNT_DP_MAX = 1 << 26;
+
+BigInt countChange(int m, int numCoins, int *coinValues) {
+	if (m < 0)
+		return BigInt(0);
+
+	vector<BigInt> ways(m + 1);
+	ways[0] = BigInt(1);
+
+	for (int i = 0; i < numCoins; i++)
+		for (int j = coinValues[i]; j <= m; j++)
+			ways[j] += ways[j - coinValues[i]];
+
+	return ways[m];
+}
+
+static uint32_t countChangeDp(int m, int numCoins, const int *coinValues, uint32_t mod) {
+	vector<uint32_t> ways(m + 1, 0);
+	ways[0] = 1 % mod;
+
+	for (int i = 0; i < numCoins; i++)
+		for (int j = coinValues[i]; j <= m; j++) {
+			uint32_t sum = ways[j] + ways[j - coinValues[i]];
+			ways[j] = sum >= mod || sum < ways[j] ? sum - mod : sum;
+		}
+
+	return ways[m];
+}
+
+/*
+ * [x^m] P(x) / Q(x), with deg P < deg Q and Q(0) = 1 (Bostan-Mori):
+ * 		P(x) / Q(x) = P(x) Q(-x) / (Q(x) Q(-x)), and Q(x) Q(-x) = V(x^2) is even,
+ * so with U(x) = P(x) Q(-x), only the coefficients of U with the parity of m matter: m halves at each step.
+ * The two products of each step go in parallel when there are threads to spare.
+ */
+static uint32_t bostanMori(long long m, vector<uint32_t> p, vector<uint32_t> q, uint32_t mod, int numThreads) {
+	while (m > 0) {
+		vector<uint32_t> qMinus = q;
+		for (size_t i = 1; i < qMinus.size(); i += 2)
+			qMinus[i] = qMinus[i] == 0 ? 0 : mod - qMinus[i];
+
+		vector<uint32_t> u, v;
+		if (numThreads > 1) {
+			thread t([&]() { u = convolutionMod(p, qMinus, mod, numThreads / 2); });
+			v = convolutionMod(q, qMinus, mod, numThreads - numThreads / 2);
+			t.join();
+		} else {
+			u = convolutionMod(p, qMinus, mod);
+			v = convolutionMod(q, qMinus, mod);
+		}
+
+		for (size_t i = 0; i < p.size(); i++) {
+			size_t k = 2 * i + (m & 1);
+			p[i] = k < u.size() ? u[k] : 0;
+		}
+		for (size_t i = 0; i < q.size(); i++)
+			q[i] = 2 * i < v.size() ? v[2 * i] : 0;
+
+		m >>= 1;
 	}
+
+	return p[0]; // q(0) = 1
 }
 
+uint32_t countChange(long long m, int numCoins, int *coinValues, uint32_t mod, int numThreads) {
+	if (m < 0 || mod == 1)
+		return 0;
+
+	long long degree = 0;
+	for (int i = 0; i < numCoins; i++)
+		degree += coinValues[i];
+	if (degree == 0)
+		return m == 0 ? 1 : 0;
+
+	double dpCost = (double) m * numCoins;
+	double polynomialCost = COUNT_DP_FACTOR * degree * (log2((double) degree) + 1) * (log2((double) m) + 1);
+	if (m <= COUNT_DP_MAX && dpCost <= polynomialCost)
+		return countChangeDp((int) m, numCoins, coinValues, mod);
 
+	// Q(x) = (1 - x^c1)(1 - x^c2)..., one coin at a time
+	vector<uint32_t> q(degree + 1, 0);
+	q[0] = 1;
+	long long top = 0;
+	for (int i = 0; i < numCoins; i++) {
+		int c = coinValues[i];
+		for (long long j = top; j >= 0; j--)
+			q[j + c] = (uint32_t) ((q[j + c] + (uint64_t) (mod - q[j])) % mod);
+		top += c;
+	}
+
+	vector<uint32_t> p(degree, 0);
+	p[0] = 1;
+
+	return bostanMori(m, p, q, mod, max(1, numThreads));
+}
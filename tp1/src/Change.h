@@ -5,7 +5,10 @@
 #ifndef CHANGE_H_
 #define CHANGE_H_
 
+#include <cstdint>
 #include <string>
+#include <vector>
+#include "BigInt.h"
 using namespace std;
 
 /* Calcula o troco num determinado montante m, utilizando um número mínimo
@@ -18,4 +21,118 @@ using namespace std;
  * */
 string calcChange(int m, int numCoins, int *coinValues);
 
+/* Versões de calcChange para quem não precisa de construir uma nova string.
+ *
+ * res - recebe o mesmo texto que calcChange devolve, reaproveitando a capacidade que já tiver
+ * buffer - recebe o mesmo texto (sem terminador), se couber nos capacity caracteres; caso contrário não é alterado.
+ *          Devolve o tamanho do texto, que permite saber quanto espaço é preciso.
+ * coinCounts - recebe, para cada moeda coinValues[i], o número de moedas desse valor usadas.
+ *              Devolve false se não for possível formar o montante m.
+ */
+void calcChange(int m, int numCoins, int *coinValues, string &res);
+size_t calcChange(int m, int numCoins, int *coinValues, char *buffer, size_t capacity);
+bool calcChange(int m, int numCoins, int *coinValues, vector<int> &coinCounts);
+
+/* Número de moedas de cada valor para montantes enormes (10^9 a 10^12 e mais), ver ChangeTable::calcChange. */
+bool calcChange(long long m, int numCoins, int *coinValues, vector<long long> &coinCounts);
+
+/* Calcula o troco com um número limitado de moedas de cada valor: no máximo coinLimits[i] moedas de valor coinValues[i].
+ * Usa programação dinâmica com uma fila monótona (mínimo de uma janela deslizante) por cada valor, em O(m * numCoins),
+ * em vez de tratar cada moeda disponível como um valor diferente.
+ * Devolve o mesmo formato que calcChange ("-" se não houver moedas suficientes),
+ * ou, na segunda versão, o número de moedas de cada valor (false se não for possível).
+ */
+string calcChange(int m, int numCoins, int *coinValues, int *coinLimits);
+bool calcChange(int m, int numCoins, int *coinValues, int *coinLimits, vector<int> &coinCounts);
+
+/* Conta as maneiras diferentes de formar o montante m com as moedas coinValues (sem limite de moedas de cada valor,
+ * sem contar a ordem), exatamente. Usa uma só linha de programação dinâmica, ways[j] += ways[j - c] para cada
+ * moeda c, em O(m * numCoins).
+ * Por exemplo: countChange(5, 3, {1, 2, 5}) = 4 (5, 2+2+1, 2+1+1+1 e 1+1+1+1+1)
+ */
+BigInt countChange(int m, int numCoins, int *coinValues);
+
+/* O mesmo, módulo mod, para montantes tão grandes quanto se queira (até ~10^18).
+ * Para m pequeno usa a mesma programação dinâmica; para m grande, o número de maneiras é o coeficiente de x^m
+ * de 1 / Q(x), com Q(x) = (1 - x^c1)(1 - x^c2)..., que se obtém pelo algoritmo de Bostan-Mori: em cada passo
+ * multiplica-se por Q(-x) e fica-se só com os coeficientes pares ou ímpares, o que divide m por dois.
+ * Custa O(D log D log m), com D = soma das moedas, e os produtos de polinómios (NTT) são divididos por numThreads threads.
+ */
+uint32_t countChange(long long m, int numCoins, int *coinValues, uint32_t mod, int numThreads = 1);
+
+/* Indica se o sistema de moedas é canónico, isto é, se o algoritmo ganancioso (dar sempre a maior moeda possível)
+ * dá sempre o número mínimo de moedas. Usa o teste de Pearson, em O(numCoins^3).
+ * Nesses sistemas, calcChange e ChangeTable respondem com o algoritmo ganancioso, em O(numCoins), sem tabela;
+ * o resultado do teste fica guardado enquanto se usarem as mesmas moedas.
+ */
+bool isCanonical(int numCoins, int *coinValues);
+
+/*
+ * Tabela de trocos para um sistema de moedas fixo, para responder a muitos pedidos de troco seguidos.
+ * A tabela (no heap) guarda, para cada montante até getMaxAmount(), o número mínimo de moedas e a primeira
+ * moeda a dar, por isso cada pedido custa apenas o número de moedas devolvidas.
+ * Um pedido de um montante maior do que os da tabela estende-a (pelo menos para o dobro) antes de responder.
+ * Se o sistema for canónico, a tabela nem chega a ser construída: os pedidos são respondidos pelo algoritmo ganancioso.
+ * Os resultados são os mesmos que os de calcChange.
+ */
+class ChangeTable {
+	vector<int> coinValues;
+	bool canonical;
+
+	/**
+	 * A partir deste montante, minCoins repete-se com período igual à maior moeda (mais uma moeda por período),
+	 * por isso a tabela nunca cresce para além dele.
+	 */
+	long long threshold;
+
+	/**
+	 * minCoins[j] - número mínimo de moedas para o montante j (-1 se for impossível)
+	 * lastCoin[j] - índice (a partir de 1) da moeda de maior valor a dar para o montante j (0 se for impossível)
+	 */
+	vector<int> minCoins;
+	vector<int> lastCoin;
+
+	void extend(int maxAmount);
+
+	void reserve(int m);
+
+	long long reduce(long long &m) const;
+
+	template <typename Visitor>
+	bool walkCoins(long long m, Visitor visit);
+
+public:
+	/* Constrói a tabela para as moedas coinValues (ordenadas por ordem crescente) até ao montante maxAmount. */
+	ChangeTable(int numCoins, int *coinValues, int maxAmount = 0);
+
+	/* Maior montante já calculado. */
+	int getMaxAmount() const;
+
+	/* Indica se o sistema de moedas é canónico (ver isCanonical). */
+	bool isCanonical() const;
+
+	/* Indica se a tabela consegue responder para o montante m. A tabela guarda no máximo MAX_TABLE_AMOUNT
+	 * (ver Change.cpp) montantes, e nos sistemas não canónicos os montantes acima dela só podem ser reduzidos
+	 * pela periodicidade a partir de (c - 1) * c' + c, com c e c' as duas maiores moedas. Se esse limiar não
+	 * couber na tabela, os montantes acima dela são recusados: getMinCoins devolve -1 e calcChange "-" ou false.
+	 */
+	bool isSupported(long long m) const;
+
+	/* Número mínimo de moedas para o montante m, ou -1 se for impossível (ou se a tabela não for suportada).
+	 * Montantes acima do limiar de periodicidade custam uma divisão e um acesso à tabela.
+	 */
+	long long getMinCoins(long long m);
+
+	/* O mesmo que as funções calcChange acima, para o sistema de moedas da tabela. */
+	string calcChange(int m);
+	void calcChange(int m, string &res);
+	size_t calcChange(int m, char *buffer, size_t capacity);
+	bool calcChange(int m, vector<int> &coinCounts);
+
+	/* Número de moedas de cada valor para montantes enormes (até ~10^18), usando a periodicidade da tabela:
+	 * só guarda montantes até ao limiar, que depende apenas das duas maiores moedas.
+	 */
+	bool calcChange(long long m, vector<long long> &coinCounts);
+};
+
 #endif /* CHANGE_H_ */
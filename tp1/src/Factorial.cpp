@@ -2,6 +2,10 @@
  * Factorial.cpp
  */
 #include "Factorial.h"
+#include "Ntt.h"
+#include <cmath>
+#include <thread>
+#include <vector>
 
 int factorialRecurs(int n) {
 	if (n <= 1)
@@ -20,3 +24,201 @@ int factorialDinam(int n) {
 
 	return res;
 }
+
+/*
+ * Below this many factors the product is done one factor at a time.
+ */
+static const int LEAF_SIZE = 64;
+
+/*
+ * Product of the integers in [low, high], splitting the range in halves (in parallel, if numThreads > 1),
+ * so that the two factors of every multiplication have about the same size.
+ */
+static BigInt product(long long low, long long high, int numThreads) {
+	if (high - low < LEAF_SIZE) {
+		BigInt res(1);
+		uint64_t chunk = 1;
+
+		// several small factors fit in a single limb before touching the big number
+		for (long long i = low; i <= high; i++) {
+			if (chunk * i >= BigInt::BASE) {
+				res *= (uint32_t) chunk;
+				chunk = 1;
+			}
+			chunk *= i;
+		}
+		res *= (uint32_t) chunk;
+
+		return res;
+	}
+
+	long long middle = (low + high) / 2;
+	BigInt left, right;
+
+	if (numThreads > 1) {
+		thread t([&]() { left = product(low, middle, numThreads / 2); });
+		right = product(middle + 1, high, numThreads - numThreads / 2);
+		t.join();
+	} else {
+		left = product(low, middle, 1);
+		right = product(middle + 1, high, 1);
+	}
+
+	return multiply(left, right, numThreads);
+}
+
+BigInt factorialBig(int n, int numThreads) {
+	if (n <= 1)
+		return BigInt(1);
+	return product(2, n, numThreads);
+}
+
+/*
+ * Below this n, n! mod p is just n modular multiplications.
+ */
+static const uint32_t NAIVE_MOD_LIMIT = 1 << 12;
+
+static uint64_t modPow(uint64_t base, uint64_t exp, uint32_t p) {
+	uint64_t res = 1;
+	for (base %= p; exp > 0; exp >>= 1) {
+		if (exp & 1)
+			res = res * base % p;
+		base = base * base % p;
+	}
+	return res;
+}
+
+/*
+ * Given h(0), ..., h(d) of a polynomial h of degree d, returns h(m), ..., h(m + d) (mod p), by Lagrange interpolation:
+ * 		h(m + k) = prod_{j=0..d} (m + k - j) * sum_i h(i) / ((m + k - i) i! (d - i)! (-1)^(d - i)),
+ * where the sum is a convolution of a_i = h(i) / (i! (d - i)! (-1)^(d - i)) with b_t = 1 / (m - d + t), t = 0 .. 2d.
+ * m - d + t must never be 0 mod p, i.e. the two sets of sample points can't overlap.
+ */
+static vector<uint32_t> shiftSamples(const vector<uint32_t> &h, uint64_t m, uint32_t p, const vector<uint32_t> &invFact) {
+	size_t d = h.size() - 1;
+
+	vector<uint32_t> a(d + 1);
+	for (size_t i = 0; i <= d; i++) {
+		uint64_t ai = (uint64_t) h[i] * invFact[i] % p * invFact[d - i] % p;
+		a[i] = (uint32_t) ((d - i) % 2 == 0 ? ai : (p - ai) % p);
+	}
+
+	// prefix products of (m - d + t), inverted all at once
+	vector<uint64_t> prefix(2 * d + 2);
+	prefix[0] = 1;
+	for (size_t t = 0; t <= 2 * d; t++)
+		prefix[t + 1] = prefix[t] * ((m + p - d + t) % p) % p;
+
+	vector<uint64_t> invPrefix(2 * d + 2);
+	invPrefix[2 * d + 1] = modPow(prefix[2 * d + 1], p - 2, p);
+	for (size_t t = 2 * d + 1; t > 0; t--)
+		invPrefix[t - 1] = invPrefix[t] * ((m + p - d + t - 1) % p) % p;
+
+	vector<uint32_t> b(2 * d + 1);
+	for (size_t t = 0; t <= 2 * d; t++)
+		b[t] = (uint32_t) (invPrefix[t + 1] * prefix[t] % p);
+
+	vector<uint32_t> c = convolutionMod(a, b, p);
+
+	vector<uint32_t> res(d + 1);
+	for (size_t k = 0; k <= d; k++) // prod_{j=0..d} (m + k - j) = prefix[k + d + 1] / prefix[k]
+		res[k] = (uint32_t) (c[k + d] * (prefix[k + d + 1] * invPrefix[k] % p) % p);
+
+	return res;
+}
+
+/*
+ * Returns g_v(0), ..., g_v(v) with g_d(x) = (vx + 1)(vx + 2)...(vx + d), building g_d up from d = 1 along the bits of v:
+ * g_2d(x) = g_d(x) g_d(x + d / v), so doubling d needs g_d at d + 1 .. 2d and at d / v + (0 .. 2d), three shifts;
+ * g_d+1(x) = g_d(x) (vx + d + 1), plus one new point.
+ * For v^2 <= p / 2 none of the shifts overlaps the points 0 .. d.
+ */
+static vector<uint32_t> blockProducts(uint32_t v, uint32_t p) {
+	vector<uint32_t> invFact(v + 1);
+	uint64_t fact = 1;
+	for (uint32_t i = 1; i <= v; i++)
+		fact = fact * i % p;
+	invFact[v] = (uint32_t) modPow(fact, p - 2, p);
+	for (uint32_t i = v; i > 0; i--)
+		invFact[i - 1] = (uint32_t) ((uint64_t) invFact[i] * i % p);
+
+	uint64_t invV = modPow(v, p - 2, p);
+
+	vector<uint32_t> g = {1, (uint32_t) ((v + 1ULL) % p)};
+	uint64_t d = 1;
+
+	int bit = 31;
+	while (!((v >> bit) & 1))
+		bit--;
+
+	for (bit--; bit >= 0; bit--) {
+		// d -> 2d
+		uint64_t shift = d * invV % p;
+		vector<uint32_t> next = shiftSamples(g, d + 1, p, invFact);
+		vector<uint32_t> other = shiftSamples(g, shift, p, invFact);
+		vector<uint32_t> otherNext = shiftSamples(g, (shift + d + 1) % p, p, invFact);
+
+		g.insert(g.end(), next.begin(), next.end() - 1);
+		other.insert(other.end(), otherNext.begin(), otherNext.end() - 1);
+		for (size_t x = 0; x < g.size(); x++)
+			g[x] = (uint32_t) ((uint64_t) g[x] * other[x] % p);
+		d *= 2;
+
+		if ((v >> bit) & 1) {
+			// d -> d + 1
+			for (uint64_t x = 0; x <= d; x++)
+				g[x] = (uint32_t) (g[x] * ((v * x + d + 1) % p) % p);
+
+			uint64_t last = 1;
+			for (uint64_t i = 1; i <= d + 1; i++)
+				last = last * ((v * (d + 1) + i) % p) % p;
+			g.push_back((uint32_t) last);
+			d++;
+		}
+	}
+
+	return g;
+}
+
+uint32_t factorialMod(uint32_t n, uint32_t p) {
+	if (n >= p)
+		return 0;
+
+	// Wilson: n! (-1)^(p - 1 - n) (p - 1 - n)! = (p - 1)! = -1
+	if (n > p / 2) {
+		uint64_t res = modPow(factorialMod(p - 1 - n, p), p - 2, p);
+		return (uint32_t) ((p - n) % 2 == 0 ? res : (p - res) % p);
+	}
+
+	uint64_t res = 1 % p;
+	uint32_t from = 1;
+
+	if (n >= NAIVE_MOD_LIMIT) {
+		uint32_t v = (uint32_t) sqrt((double) n);
+		while ((uint64_t) v * v > n)
+			v--;
+		while ((uint64_t) (v + 1) * (v + 1) <= n)
+			v++;
+
+		vector<uint32_t> g = blockProducts(v, p);
+		for (uint32_t x = 0; x < v; x++)
+			res = res * g[x] % p;
+		from = v * v + 1;
+	}
+
+	for (uint64_t i = from; i <= n; i++)
+		res = res * i % p;
+
+	return (uint32_t) res;
+}
+
+void factorialsMod(int n, uint32_t p, vector<uint32_t> &fact, vector<uint32_t> &invFact) {
+	fact.assign(n + 1, 1 % p);
+	for (int i = 1; i <= n; i++)
+		fact[i] = (uint32_t) ((uint64_t) fact[i - 1] * i % p);
+
+	invFact.assign(n + 1, 0);
+	invFact[n] = (uint32_t) modPow(fact[n], p - 2, p);
+	for (int i = n; i > 0; i--)
+		invFact[i - 1] = (uint32_t) ((uint64_t) invFact[i] * i % p);
+}
@@ -5,6 +5,8 @@
 #ifndef FACTORIAL_H_
 #define FACTORIAL_H_
 
+#include "BigInt.h"
+#include <cstdint>
 
 /*Calcula o factorial de um valor de entrada n (>=0) usando recursividade*/
 int factorialRecurs(int n);
@@ -12,5 +14,49 @@ int factorialRecurs(int n);
 /*Calcula o factorial de um valor de entrada n (>=0) usando programação dinâmica*/
 int factorialDinam(int n);
 
+/*Calcula o factorial de n (>=0) exatamente, como inteiro de precisão arbitrária.
+ *Multiplica os números de 1 a n numa árvore de produtos equilibrada (os fatores de cada multiplicação têm
+ *tamanhos parecidos, o que permite usar Karatsuba), dividindo as subárvores e as multiplicações por numThreads threads.*/
+BigInt factorialBig(int n, int numThreads = 1);
+
+/*Maiores n cujo factorial cabe num inteiro sem sinal de 64 e de 128 bits, respetivamente.*/
+const int MAX_FACTORIAL_64 = 20;
+const int MAX_FACTORIAL_128 = 34;
+
+/*Tabela com os factoriais de 0 a size - 1, gerada em tempo de compilação.*/
+template<typename T, int size>
+struct FactorialTable {
+	T values[size];
+
+	constexpr FactorialTable() : values() {
+		values[0] = 1;
+		for (int i = 1; i < size; i++)
+			values[i] = values[i - 1] * (T) i;
+	}
+};
+
+constexpr FactorialTable<uint64_t, MAX_FACTORIAL_64 + 1> FACTORIALS_64{};
+constexpr FactorialTable<unsigned __int128, MAX_FACTORIAL_128 + 1> FACTORIALS_128{};
+
+/*Devolve o factorial de n (0 <= n <= MAX_FACTORIAL_64) por consulta à tabela, em O(1).*/
+constexpr uint64_t factorial64(int n) {
+	return FACTORIALS_64.values[n];
+}
+
+/*Devolve o factorial de n (0 <= n <= MAX_FACTORIAL_128) por consulta à tabela, em O(1).*/
+constexpr unsigned __int128 factorial128(int n) {
+	return FACTORIALS_128.values[n];
+}
+
+/*Calcula n! mod p, para p primo. Devolve 0 se n >= p.
+ *Para n grande, em vez de n multiplicações, usa o algoritmo de deslocamento de pontos de amostragem:
+ *com v = raiz quadrada de n, avalia g(x) = (vx + 1)(vx + 2)...(vx + v) em x = 0, 1, ..., v - 1, cujo produto
+ *é (v^2)!, com interpolação de Lagrange feita por convoluções NTT. Custo O(raiz(n) log n), o que dá para
+ *n até 10^9 e mais. Para n > p / 2 usa o teorema de Wilson, (p - 1)! = -1 mod p.*/
+uint32_t factorialMod(uint32_t n, uint32_t p);
+
+/*Preenche fact com 0!, 1!, ..., n! módulo o primo p (n < p) e invFact com os seus inversos módulo p, em O(n):
+ *só n! é invertido (pelo pequeno teorema de Fermat); os outros inversos saem de 1/(i-1)! = i/i!.*/
+void factorialsMod(int n, uint32_t p, vector<uint32_t> &fact, vector<uint32_t> &invFact);
 
 #endif /* FACTORIAL_H_ */
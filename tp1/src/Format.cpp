@@ -0,0 +1,39 @@
+/*
+ * Format.cpp
+ */
+
+#include "Format.h"
+
+int intLength(long long value) {
+	unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long) value : (unsigned long long) value;
+	int length = value < 0 ? 2 : 1;
+
+	while (magnitude >= 10) {
+		magnitude /= 10;
+		length++;
+	}
+
+	return length;
+}
+
+int writeInt(char *buffer, long long value) {
+	// the magnitude is taken as unsigned so the smallest long long doesn't overflow
+	unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long) value : (unsigned long long) value;
+	int length = intLength(value);
+	char *digit = buffer + length;
+
+	do {
+		*--digit = (char) ('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude > 0);
+
+	if (value < 0)
+		buffer[0] = '-';
+
+	return length;
+}
+
+void appendInt(string &res, long long value) {
+	char buffer[MAX_INT_CHARS];
+	res.append(buffer, writeInt(buffer, value));
+}
@@ -0,0 +1,26 @@
+/*
+ * Format.h
+ */
+
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include <string>
+using namespace std;
+
+/* Número máximo de caracteres de um long long escrito em decimal (com sinal). */
+const int MAX_INT_CHARS = 20;
+
+/* Número de caracteres que writeInt escreve para value. */
+int intLength(long long value);
+
+/* Escreve value em decimal no buffer, sem terminador, e devolve o número de caracteres escritos.
+ * O buffer tem de ter espaço para intLength(value) caracteres. Não aloca memória (equivalente a std::to_chars).
+ */
+int writeInt(char *buffer, long long value);
+
+/* Acrescenta value em decimal ao fim de res. Não aloca se res já tiver capacidade reservada.
+ */
+void appendInt(string &res, long long value);
+
+#endif /* FORMAT_H_ */
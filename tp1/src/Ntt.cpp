@@ -0,0 +1,225 @@
+/*
+ * Ntt.cpp
+ */
+
+#include "Ntt.h"
+#include <algorithm>
+#include <thread>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NTT_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+template <uint32_t MOD>
+uint32_t powMod(uint32_t base, uint64_t exp) {
+	uint64_t res = 1, b = base % MOD;
+	for (; exp > 0; exp >>= 1) {
+		if (exp & 1)
+			res = res * b % MOD;
+		b = b * b % MOD;
+	}
+	return (uint32_t) res;
+}
+
+/*
+ * One round of butterflies over a block: lo[k], hi[k] = lo[k] + roots[k] hi[k], lo[k] - roots[k] hi[k].
+ * MOD being a compile time constant lets the compiler turn every % into multiplications.
+ */
+template <uint32_t MOD>
+static void butterfliesScalar(uint32_t *lo, uint32_t *hi, const uint32_t *roots, const uint32_t *, size_t half) {
+	for (size_t k = 0; k < half; k++) {
+		uint32_t u = lo[k];
+		uint32_t v = (uint32_t) ((uint64_t) hi[k] * roots[k] % MOD);
+		lo[k] = u + v < MOD ? u + v : u + v - MOD;
+		hi[k] = u >= v ? u - v : u + MOD - v;
+	}
+}
+
+#ifdef NTT_X86_KERNELS
+/*
+ * -MOD^-1 mod 2^32, by Newton's iteration (each step doubles the correct low bits).
+ */
+static constexpr uint32_t montgomeryFactor(uint32_t mod) {
+	uint32_t inverse = mod;
+	for (int i = 0; i < 5; i++)
+		inverse *= 2 - mod * inverse;
+	return 0u - inverse;
+}
+
+/*
+ * Eight Montgomery products a b 2^-32 mod MOD (MOD < 2^30). With b = root 2^32 mod MOD that is just a * root mod MOD.
+ * _mm256_mul_epu32 only multiplies the even 32 bit lanes, so the odd ones go through a second round, shifted down.
+ */
+__attribute__((target("avx2")))
+static inline __m256i montgomeryMul(__m256i a, __m256i b, __m256i mod, __m256i factor) {
+	__m256i evenProduct = _mm256_mul_epu32(a, b);
+	__m256i oddProduct = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+
+	__m256i evenQuotient = _mm256_mul_epu32(evenProduct, factor);
+	__m256i oddQuotient = _mm256_mul_epu32(oddProduct, factor);
+
+	__m256i even = _mm256_add_epi64(evenProduct, _mm256_mul_epu32(evenQuotient, mod));
+	__m256i odd = _mm256_add_epi64(oddProduct, _mm256_mul_epu32(oddQuotient, mod));
+
+	// the results are the high halves of every 64 bit lane, below 2 MOD
+	__m256i res = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+	return _mm256_min_epu32(res, _mm256_sub_epi32(res, mod));
+}
+
+/*
+ * The same butterflies, eight at a time, with the roots given in Montgomery form (root 2^32 mod MOD).
+ */
+template <uint32_t MOD>
+__attribute__((target("avx2")))
+static void butterfliesAvx2(uint32_t *lo, uint32_t *hi, const uint32_t *, const uint32_t *montRoots, size_t half) {
+	const __m256i mod = _mm256_set1_epi32(MOD);
+	const __m256i factor = _mm256_set1_epi32(montgomeryFactor(MOD));
+
+	for (size_t k = 0; k < half; k += 8) {
+		__m256i u = _mm256_loadu_si256((const __m256i *) (lo + k));
+		__m256i v = montgomeryMul(_mm256_loadu_si256((const __m256i *) (hi + k)),
+				_mm256_loadu_si256((const __m256i *) (montRoots + k)), mod, factor);
+
+		__m256i sum = _mm256_add_epi32(u, v);
+		__m256i diff = _mm256_add_epi32(_mm256_sub_epi32(u, v), mod);
+		_mm256_storeu_si256((__m256i *) (lo + k), _mm256_min_epu32(sum, _mm256_sub_epi32(sum, mod)));
+		_mm256_storeu_si256((__m256i *) (hi + k), _mm256_min_epu32(diff, _mm256_sub_epi32(diff, mod)));
+	}
+}
+#endif
+
+static bool useAvx2() {
+#ifdef NTT_X86_KERNELS
+	static const bool supported = __builtin_cpu_supports("avx2");
+	return supported;
+#else
+	return false;
+#endif
+}
+
+/*
+ * Iterative radix-2 transform: bit reversal permutation, then log n rounds of butterflies.
+ * Rounds with at least 8 butterflies per block run eight at a time with AVX2, when the processor has it.
+ */
+template <uint32_t MOD>
+void ntt(vector<uint32_t> &a, bool invert) {
+	const uint32_t ROOT = 3;
+	size_t n = a.size();
+
+	for (size_t i = 1, j = 0; i < n; i++) {
+		size_t bit = n >> 1;
+		for (; j & bit; bit >>= 1)
+			j ^= bit;
+		j ^= bit;
+		if (i < j)
+			swap(a[i], a[j]);
+	}
+
+	bool vectorized = useAvx2();
+	vector<uint32_t> roots(n / 2 + 1), montRoots(vectorized ? n / 2 + 1 : 0);
+
+	for (size_t len = 2; len <= n; len <<= 1) {
+		uint64_t w = powMod<MOD>(ROOT, (MOD - 1) / len);
+		if (invert)
+			w = powMod<MOD>((uint32_t) w, MOD - 2);
+
+		size_t half = len / 2;
+		roots[0] = 1;
+		for (size_t k = 1; k < half; k++)
+			roots[k] = (uint32_t) (roots[k - 1] * w % MOD);
+
+		void (*butterflies)(uint32_t *, uint32_t *, const uint32_t *, const uint32_t *, size_t) = butterfliesScalar<MOD>;
+#ifdef NTT_X86_KERNELS
+		if (vectorized && half >= 8) {
+			for (size_t k = 0; k < half; k++)
+				montRoots[k] = (uint32_t) (((uint64_t) roots[k] << 32) % MOD);
+			butterflies = butterfliesAvx2<MOD>;
+		}
+#endif
+
+		for (size_t i = 0; i < n; i += len)
+			butterflies(&a[i], &a[i + half], roots.data(), montRoots.data(), half);
+	}
+
+	if (invert) {
+		uint64_t inverse = powMod<MOD>((uint32_t) n, MOD - 2);
+		for (uint32_t &x : a)
+			x = (uint32_t) (x * inverse % MOD);
+	}
+}
+
+template <uint32_t MOD>
+vector<uint32_t> convolution(const vector<uint32_t> &a, const vector<uint32_t> &b) {
+	if (a.empty() || b.empty())
+		return vector<uint32_t>();
+
+	size_t resultSize = a.size() + b.size() - 1;
+	size_t n = 1;
+	while (n < resultSize)
+		n <<= 1;
+
+	vector<uint32_t> fa(n, 0), fb(n, 0);
+	for (size_t i = 0; i < a.size(); i++)
+		fa[i] = a[i] % MOD;
+	for (size_t i = 0; i < b.size(); i++)
+		fb[i] = b[i] % MOD;
+
+	ntt<MOD>(fa, false);
+	ntt<MOD>(fb, false);
+	for (size_t i = 0; i < n; i++)
+		fa[i] = (uint32_t) ((uint64_t) fa[i] * fb[i] % MOD);
+	ntt<MOD>(fa, true);
+
+	fa.resize(resultSize);
+	return fa;
+}
+
+unsigned __int128 crt(uint32_t ra, uint32_t rb, uint32_t rc) {
+	const uint64_t P1 = NTT_MOD_A, P2 = NTT_MOD_B, P3 = NTT_MOD_C;
+	static const uint64_t INV_P1_MOD_P2 = powMod<NTT_MOD_B>((uint32_t) (P1 % P2), P2 - 2);
+	static const uint64_t INV_P1P2_MOD_P3 = powMod<NTT_MOD_C>((uint32_t) (P1 * P2 % P3), P3 - 2);
+
+	uint64_t x1 = ra;
+	uint64_t x2 = (rb + P2 - x1 % P2) % P2 * INV_P1_MOD_P2 % P2;
+	uint64_t x12 = x1 + P1 * x2; // < P1 * P2
+	uint64_t x3 = (rc + P3 - x12 % P3) % P3 * INV_P1P2_MOD_P3 % P3;
+
+	return x12 + (unsigned __int128) (P1 * P2) * x3;
+}
+
+vector<uint32_t> convolutionMod(const vector<uint32_t> &a, const vector<uint32_t> &b, uint32_t mod, int numThreads) {
+	vector<uint32_t> c1, c2, c3;
+
+	if (numThreads >= 3) {
+		thread t1([&]() { c1 = convolution<NTT_MOD_A>(a, b); });
+		thread t2([&]() { c2 = convolution<NTT_MOD_B>(a, b); });
+		c3 = convolution<NTT_MOD_C>(a, b);
+		t1.join();
+		t2.join();
+	} else if (numThreads == 2) {
+		thread t1([&]() { c1 = convolution<NTT_MOD_A>(a, b); });
+		c2 = convolution<NTT_MOD_B>(a, b);
+		t1.join();
+		c3 = convolution<NTT_MOD_C>(a, b);
+	} else {
+		c1 = convolution<NTT_MOD_A>(a, b);
+		c2 = convolution<NTT_MOD_B>(a, b);
+		c3 = convolution<NTT_MOD_C>(a, b);
+	}
+
+	for (size_t i = 0; i < c1.size(); i++)
+		c1[i] = (uint32_t) (crt(c1[i], c2[i], c3[i]) % mod);
+
+	return c1;
+}
+
+template uint32_t powMod<NTT_MOD_A>(uint32_t, uint64_t);
+template uint32_t powMod<NTT_MOD_B>(uint32_t, uint64_t);
+template uint32_t powMod<NTT_MOD_C>(uint32_t, uint64_t);
+template void ntt<NTT_MOD_A>(vector<uint32_t> &, bool);
+template void ntt<NTT_MOD_B>(vector<uint32_t> &, bool);
+template void ntt<NTT_MOD_C>(vector<uint32_t> &, bool);
+template vector<uint32_t> convolution<NTT_MOD_A>(const vector<uint32_t> &, const vector<uint32_t> &);
+template vector<uint32_t> convolution<NTT_MOD_B>(const vector<uint32_t> &, const vector<uint32_t> &);
+template vector<uint32_t> convolution<NTT_MOD_C>(const vector<uint32_t> &, const vector<uint32_t> &);
@@ -0,0 +1,44 @@
+/*
+ * Ntt.h
+ */
+
+#ifndef NTT_H_
+#define NTT_H_
+
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+/* Primos da forma c * 2^k + 1 com raiz primitiva 3, usados nas transformadas. */
+const uint32_t NTT_MOD_A = 998244353; // 119 * 2^23 + 1
+const uint32_t NTT_MOD_B = 167772161; // 5 * 2^25 + 1
+const uint32_t NTT_MOD_C = 469762049; // 7 * 2^26 + 1
+
+/* Potência modular: base^exp mod MOD. */
+template <uint32_t MOD>
+uint32_t powMod(uint32_t base, uint64_t exp);
+
+/* Transformada numérica (NTT) de a, no lugar, módulo MOD. O tamanho de a tem de ser uma potência de 2.
+ * Com invert, calcula a transformada inversa (já dividida pelo tamanho).
+ */
+template <uint32_t MOD>
+void ntt(vector<uint32_t> &a, bool invert);
+
+/* Convolução (produto de polinómios) de a e b, módulo MOD, em O(n log n).
+ * Os coeficientes de a e b podem ser maiores do que MOD (são reduzidos primeiro).
+ */
+template <uint32_t MOD>
+vector<uint32_t> convolution(const vector<uint32_t> &a, const vector<uint32_t> &b);
+
+/* Reconstrói, pelo teorema chinês dos restos, o número x < NTT_MOD_A * NTT_MOD_B * NTT_MOD_C (~7.8 * 10^25)
+ * a partir dos seus restos módulo cada um dos três primos.
+ */
+unsigned __int128 crt(uint32_t ra, uint32_t rb, uint32_t rc);
+
+/* Convolução de a e b módulo um mod qualquer (não tem de ser um primo NTT), com três convoluções NTT
+ * (em paralelo, se numThreads > 1).
+ * É exata enquanto min(|a|, |b|) * mod^2 for menor do que o produto dos três primos.
+ */
+vector<uint32_t> convolutionMod(const vector<uint32_t> &a, const vector<uint32_t> &b, uint32_t mod, int numThreads = 1);
+
+#endif /* NTT_H_ */
@@ -2,8 +2,9 @@
  * Partioning.cpp
  */
 
-#include <malloc.h>
 #include "Partitioning.h"
+#include "Factorial.h"
+#include "Ntt.h"
 
 
 int s_recursive(int n, int k) {
@@ -40,15 +41,14 @@ int b_recursive(int n) {
 
 /*
  * Goes top down in the table, storing the array of the last n and the current array.
+ * Both arrays are allocated once, with room for the longest row, and swapped after each row.
  */
 int b_dynamic(int n) {
-	int *last = (int *) malloc(sizeof(int)); // the array of the last n
-	int *current; // the current array
+	vector<int> last(n + 1); // the array of the last n
+	vector<int> current(n + 1); // the current array
 	int sum = 0;
 
 	for (int i = 0; i < n; i++) {
-		current = (int *)malloc(sizeof(int) * i + 1);
-
 		current[0] = 1;
 		for (int j = 1; j < i; j++) {
 			current[j] = last[j - 1] + (j + 1) * last[j];
@@ -57,14 +57,163 @@ int b_dynamic(int n) {
 		}
 		current[i] = 1;
 
-		free(last); // since last = current in the next line, this frees the array that won't be useful anymore, aka used "last" or the previous "current"
-		last = current;
+		swap(last, current); // the current array is the last one of the next n, and the old last one gets reused
 	}
-	free(last);
 
 	sum += 2; // (this is later (first and last number of the array, which are 1))
 
 	return sum;
 }
 
+/*
+ * One pass over the Bell triangle keeping only the current row, updated in place:
+ * new[0] = old[i - 1], new[j + 1] = new[j] + old[j], so B(i + 1) = new[0] of the next row = the last of this one.
+ */
+template<typename T>
+static bool bellTriangle(int n, vector<T> &bell) {
+	bell.assign(max(n, 0) + 1, T(0));
+	bell[0] = T(1);
+
+	vector<T> row;
+	row.reserve(max(n, 1));
+	row.push_back(T(1));
+
+	for (int i = 0; i < n; i++) {
+		bell[i + 1] = row.back();
+		if (i == n - 1)
+			break;
+
+		T carry = row.back();
+		for (T &cell : row) {
+			swap(cell, carry); // cell = new[j], carry = old[j]
+			if (!addChecked(carry, cell))
+				return false;
+		}
+		row.push_back(carry);
+	}
+
+	return true;
+}
+
+bool bellNumbers(int n, vector<uint64_t> &bell) {
+	return bellTriangle(n, bell);
+}
+
+bool bellNumbers(int n, vector<unsigned __int128> &bell) {
+	return bellTriangle(n, bell);
+}
+
+void bellNumbers(int n, vector<BigInt> &bell) {
+	bellTriangle(n, bell);
+}
+
+void bellNumbersMod(int n, uint32_t p, vector<uint32_t> &bell) {
+	bell.assign(max(n, 0) + 1, 0);
+	bell[0] = 1 % p;
+
+	vector<uint32_t> row(1, 1 % p);
+	row.reserve(max(n, 1));
+
+	for (int i = 0; i < n; i++) {
+		bell[i + 1] = row.back();
+		if (i == n - 1)
+			break;
+
+		uint32_t carry = row.back();
+		for (uint32_t &cell : row) {
+			uint32_t old = cell;
+			cell = carry;
+			carry = (uint32_t) (((uint64_t) carry + old) % p);
+		}
+		row.push_back(carry);
+	}
+}
 
+/*
+ * a * b mod (x^p - x - 1), both of degree < p: x^(p + k) = x^(k + 1) + x^k.
+ */
+static vector<uint32_t> mulTouchard(const vector<uint32_t> &a, const vector<uint32_t> &b, uint32_t p) {
+	vector<uint32_t> c = convolutionMod(a, b, p);
+	c.resize(2 * p - 1, 0);
+
+	for (size_t k = c.size() - 1; k >= p; k--) {
+		c[k - p + 1] = (uint32_t) (((uint64_t) c[k - p + 1] + c[k]) % p);
+		c[k - p] = (uint32_t) (((uint64_t) c[k - p] + c[k]) % p);
+	}
+
+	c.resize(p);
+	return c;
+}
+
+uint32_t bellMod(unsigned long long n, uint32_t p) {
+	if (n < p) {
+		vector<uint32_t> bell;
+		bellNumbersMod((int) n, p, bell);
+		return bell[n];
+	}
+
+	vector<uint32_t> bell;
+	bellNumbersMod(p - 1, p, bell);
+
+	// x^n mod (x^p - x - 1), from the most significant bit down
+	vector<uint32_t> power(p, 0);
+	power[0] = 1;
+
+	int bit = 63;
+	while (!((n >> bit) & 1))
+		bit--;
+	for (; bit >= 0; bit--) {
+		power = mulTouchard(power, power, p);
+		if ((n >> bit) & 1) {
+			// times x: shift up, and the top coefficient wraps around to x + 1
+			uint32_t top = power[p - 1];
+			for (uint32_t k = p - 1; k > 0; k--)
+				power[k] = power[k - 1];
+			power[0] = top;
+			power[1] = (uint32_t) (((uint64_t) power[1] + top) % p);
+		}
+	}
+
+	uint64_t res = 0;
+	for (uint32_t i = 0; i < p; i++)
+		res = (res + (uint64_t) power[i] * bell[i]) % p;
+
+	return (uint32_t) res;
+}
+
+void stirlingRowMod(int n, vector<uint32_t> &row) {
+	static_assert(STIRLING_MOD == NTT_MOD_A, "the row is a single NTT convolution");
+	const uint32_t MOD = STIRLING_MOD;
+
+	vector<uint32_t> fact, invFact;
+	factorialsMod(n, MOD, fact, invFact);
+
+	// powers[j] = j^n, multiplicative in j: smallest prime factors by a linear sieve
+	vector<uint32_t> powers(n + 1, 0), primes;
+	powers[0] = n == 0 ? 1 : 0;
+	if (n >= 1)
+		powers[1] = 1;
+	for (int j = 2; j <= n; j++) {
+		if (powers[j] == 0) {
+			powers[j] = powMod<NTT_MOD_A>(j, n);
+			primes.push_back(j);
+		}
+		for (uint32_t prime : primes) {
+			long long multiple = (long long) prime * j;
+			if (multiple > n)
+				break;
+			powers[multiple] = (uint32_t) ((uint64_t) powers[prime] * powers[j] % MOD);
+			if (j % prime == 0)
+				break;
+		}
+	}
+
+	vector<uint32_t> a(n + 1), b(n + 1);
+	for (int i = 0; i <= n; i++) {
+		a[i] = i % 2 == 0 ? invFact[i] : (MOD - invFact[i]) % MOD;
+		b[i] = (uint32_t) ((uint64_t) powers[i] * invFact[i] % MOD);
+	}
+
+	row = convolution<NTT_MOD_A>(a, b);
+	row.resize(n + 1);
+}
@@ -5,6 +5,10 @@
 #ifndef PARTITIONING_H_
 #define PARTITIONING_H_
 
+#include "BigInt.h"
+#include <mutex>
+#include <vector>
+
 /*Implementa a função s(n,k) usando recursividade*/
 int s_recursive(int n,int k);
 
@@ -17,4 +21,144 @@ int s_dynamic(int n,int k);
 /*Implementa a função b(n) usando programação dinâmica*/
 int b_dynamic(int n);
 
-#endif /* SUM_H_ */
+/*Calcula os números de Bell B(0), ..., B(n) de uma só vez, pelo triângulo de Bell (Aitken), em O(n^2)
+ *e com memória O(n): cada linha começa no último elemento da anterior e cada elemento seguinte é a soma do que está
+ *à sua esquerda com o que está por cima desse; B(i) é o primeiro elemento da linha i.
+ *Nas versões de tamanho fixo, devolve false se B(n) não couber no tipo.*/
+bool bellNumbers(int n, vector<uint64_t> &bell);
+bool bellNumbers(int n, vector<unsigned __int128> &bell);
+void bellNumbers(int n, vector<BigInt> &bell);
+
+/*Calcula B(0), ..., B(n) módulo p, pelo mesmo triângulo.*/
+void bellNumbersMod(int n, uint32_t p, vector<uint32_t> &bell);
+
+/*Calcula B(n) módulo um primo p, para n tão grande quanto se queira.
+ *Pela congruência de Touchard, B(m + p) = B(m) + B(m + 1) mod p, por isso B(n) = soma de c_i B(i), com
+ *x^n = soma de c_i x^i módulo x^p - x - 1. Custa O(p^2) para B(0..p-1) e O(p log p log n) para a potência
+ *(multiplicações de polinómios com NTT), o que serve para primos até alguns milhares.*/
+uint32_t bellMod(unsigned long long n, uint32_t p);
+
+/*Calcula a linha inteira S(n, 0), ..., S(n, n) módulo STIRLING_MOD (998244353), em O(n log n), pela fórmula explícita
+ *(inclusão-exclusão) S(n, k) = soma de (-1)^i / i! * (k - i)^n / (k - i)! para i de 0 a k, que é uma convolução
+ *de a_i = (-1)^i / i! com b_j = j^n / j!, feita com NTT. Os j^n saem de um crivo linear: só se calculam potências
+ *de primos, os outros são produtos de potências já calculadas.*/
+const uint32_t STIRLING_MOD = 998244353;
+void stirlingRowMod(int n, vector<uint32_t> &row);
+
+/* Somas e produtos das células da PartitionTable, que devolvem false se o resultado não couber no tipo. */
+inline bool addChecked(uint64_t &a, const uint64_t &b) { return !__builtin_add_overflow(a, b, &a); }
+inline bool addChecked(unsigned __int128 &a, const unsigned __int128 &b) { return !__builtin_add_overflow(a, b, &a); }
+inline bool addChecked(BigInt &a, const BigInt &b) { a += b; return true; }
+
+inline bool mulChecked(uint64_t &a, uint32_t k) { return !__builtin_mul_overflow(a, (uint64_t) k, &a); }
+inline bool mulChecked(unsigned __int128 &a, uint32_t k) { return !__builtin_mul_overflow(a, (unsigned __int128) k, &a); }
+inline bool mulChecked(BigInt &a, uint32_t k) { a *= k; return true; }
+
+/*
+ * Tabela dos números de Stirling de segunda espécie S(n, k) e dos números de Bell B(n), com células do tipo T
+ * (uint64_t, unsigned __int128 ou BigInt), que pode ser partilhada por várias threads.
+ * As linhas são calculadas só quando são precisas, uma a uma a partir da anterior (com dois vetores reaproveitados),
+ * e ficam guardadas: depois disso, cada consulta é um acesso à tabela, em O(1).
+ * Com inteiros de tamanho fixo, a tabela pára na última linha cujo número de Bell cabe em T
+ * (n = 25 para 64 bits e n = 42 para 128 bits); acima disso as consultas devolvem false.
+ */
+template<typename T>
+class PartitionTable {
+	/**
+	 * stirling[n * (n + 1) / 2 + k] - S(n, k), com 0 <= k <= n
+	 * bell[n] - B(n)
+	 */
+	vector<T> stirling;
+	vector<T> bell;
+
+	/**
+	 * last - a última linha calculada; next - a linha seguinte, enquanto é calculada
+	 */
+	vector<T> last, next;
+
+	/**
+	 * Número de linhas calculadas, e se já se chegou à última que cabe em T.
+	 */
+	int numRows = 0;
+	bool full = false;
+
+	mutable mutex lock;
+
+	// computes rows up to n, returns false if row n doesn't fit in T
+	bool grow(int n) {
+		if (numRows == 0) {
+			last.assign(1, T(1));
+			stirling.push_back(T(1));
+			bell.push_back(T(1));
+			numRows = 1;
+		}
+
+		while (numRows <= n && !full) {
+			int row = numRows;
+			next.resize(row + 1);
+			next[0] = T(0);
+			next[row] = T(1);
+
+			T sum = T(1);
+			bool fits = true;
+			// S(row, k) = S(row - 1, k - 1) + k S(row - 1, k)
+			for (int k = 1; k < row && fits; k++) {
+				next[k] = last[k];
+				fits = mulChecked(next[k], k) && addChecked(next[k], last[k - 1]) && addChecked(sum, next[k]);
+			}
+
+			if (!fits) {
+				full = true;
+				break;
+			}
+
+			stirling.insert(stirling.end(), next.begin(), next.end());
+			bell.push_back(sum);
+			swap(last, next);
+			numRows++;
+		}
+
+		return n < numRows;
+	}
+
+public:
+	/* A tabela de cada tipo usada por todo o programa. */
+	static PartitionTable &shared() {
+		static PartitionTable table;
+		return table;
+	}
+
+	/* Coloca S(n, k) em value (0 se k > n). Devolve false se n < 0, k < 0 ou S(n, k) não couber em T. */
+	bool getStirling(int n, int k, T &value) {
+		if (n < 0 || k < 0)
+			return false;
+
+		lock_guard<mutex> guard(lock);
+		if (!grow(n))
+			return false;
+
+		value = k > n ? T(0) : stirling[(size_t) n * (n + 1) / 2 + k];
+		return true;
+	}
+
+	/* Coloca B(n) em value. Devolve false se n < 0 ou B(n) não couber em T. */
+	bool getBell(int n, T &value) {
+		if (n < 0)
+			return false;
+
+		lock_guard<mutex> guard(lock);
+		if (!grow(n))
+			return false;
+
+		value = bell[n];
+		return true;
+	}
+
+	/* Número de linhas já calculadas. */
+	int getNumRows() const {
+		lock_guard<mutex> guard(lock);
+		return numRows;
+	}
+};
+
+#endif /* PARTITIONING_H_ */
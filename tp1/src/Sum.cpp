@@ -3,8 +3,30 @@
  */
 
 #include "Sum.h"
+#include "Benchmark.h"
+#include "Format.h"
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <limits>
+#include <type_traits>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SUM_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SUM_X86_KERNELS
+#include <immintrin.h>
+#endif
 
 string &fillFirstIteration(const int *sequence, int size, int *values, string &res);
 
@@ -16,6 +38,42 @@ int getSum(const int *sequence, int iteration, int amount);
 
 string buildResString(int size, const int *bestSums, const int *bestIndexes);
 
+string buildResString(long long size, const long long *bestSums, const long long *bestIndexes);
+
+void buildPrefixSums(const int *sequence, int size, int *prefix);
+
+static void minWindowSums(int *sequence, int size, vector<int> &bestSums, vector<int> &bestIndexes);
+
+/*
+ * The result is formatted in two passes: first the exact length is computed, then the text is written
+ * straight into its final place, with no temporary strings.
+ */
+template <typename T>
+static size_t resultLength(long long size, const T *bestSums, const T *bestIndexes) {
+    size_t length = 0;
+    for (long long i = 0; i < size; ++i)
+        length += intLength(bestSums[i]) + intLength(bestIndexes[i]) + 2;
+    return length;
+}
+
+template <typename T>
+static char *writeResult(char *out, long long size, const T *bestSums, const T *bestIndexes) {
+    for (long long i = 0; i < size; ++i) {
+        out += writeInt(out, bestSums[i]);
+        *out++ = ',';
+        out += writeInt(out, bestIndexes[i]);
+        *out++ = ';';
+    }
+    return out;
+}
+
+template <typename T>
+static void formatResult(long long size, const T *bestSums, const T *bestIndexes, string &res) {
+    res.resize(resultLength(size, bestSums, bestIndexes));
+    if (!res.empty())
+        writeResult(&res[0], size, bestSums, bestIndexes);
+}
+
 /*
  * ALTERNATIVE METHOD: less efficient spatially.
  *
@@ -52,15 +110,18 @@ string calcSum2(int *sequence, int size) {
 
 		updateValues(values, iteration, qtNumbers, bestIndex, bestSum);
 
-		res += to_string(bestSum) + "," + to_string(bestIndex) + ";";
+		appendInt(res, bestSum);
+		res += ',';
+		appendInt(res, bestIndex);
+		res += ';';
 	}
 
 	return res;
 }
 
 string calcSum(int *sequence, int size) {
-    int bestSums[size];
-    int bestIndexes[size];
+    vector<int> bestSums(size);
+    vector<int> bestIndexes(size);
 
     for (int iteration = 0; iteration < size; ++iteration) {
         int bestIndex = 0;
@@ -79,13 +140,960 @@ string calcSum(int *sequence, int size) {
         bestIndexes[iteration] = bestIndex;
     }
 
-    return buildResString(size, bestSums, bestIndexes);
+    return buildResString(size, bestSums.data(), bestIndexes.data());
+}
+
+/*
+ * Kernels that, given the prefix sums P of the sequence, find the minimum of P[i + window] - P[i]
+ * for 0 <= i < count, keeping the first index where it happens (just like calcSum does).
+ *
+ * The prefix sums are kept as wrapping 32 bit integers: the difference of two of them is the exact
+ * window sum whenever that sum fits in an int, which is always the case when calcSum itself doesn't overflow.
+ */
+typedef void (*MinWindowKernel)(const int *prefix, int count, int window, int &bestSum, int &bestIndex);
+
+static inline int windowSum(const int *prefix, int i, int window) {
+	return (int) ((unsigned) prefix[i + window] - (unsigned) prefix[i]);
+}
+
+static void minWindowScalar(const int *prefix, int count, int window, int &bestSum, int &bestIndex) {
+	bestSum = numeric_limits<int>::max();
+	bestIndex = 0;
+
+	for (int i = 0; i < count; ++i) {
+		int sum = windowSum(prefix, i, window);
+		if (sum < bestSum) {
+			bestSum = sum;
+			bestIndex = i;
+		}
+	}
+}
+
+#ifdef SUM_X86_KERNELS
+/*
+ * Each lane keeps its own minimum and the first index where it found it, so in the end the answer is the
+ * smallest lane value, breaking ties by the smallest index. The remaining windows are done one by one.
+ */
+static void reduceLanes(const int *sums, const int *indexes, int lanes, int &bestSum, int &bestIndex) {
+	bestSum = numeric_limits<int>::max();
+	bestIndex = 0;
+
+	for (int lane = 0; lane < lanes; ++lane) {
+		if (sums[lane] < bestSum || (sums[lane] == bestSum && indexes[lane] < bestIndex)) {
+			bestSum = sums[lane];
+			bestIndex = indexes[lane];
+		}
+	}
+}
+
+static void minWindowTail(const int *prefix, int from, int count, int window, int &bestSum, int &bestIndex) {
+	for (int i = from; i < count; ++i) {
+		int sum = windowSum(prefix, i, window);
+		if (sum < bestSum) {
+			bestSum = sum;
+			bestIndex = i;
+		}
+	}
+}
+
+static void minWindowSse(const int *prefix, int count, int window, int &bestSum, int &bestIndex) {
+	__m128i best = _mm_set1_epi32(numeric_limits<int>::max());
+	__m128i bestIdx = _mm_setzero_si128();
+	__m128i idx = _mm_setr_epi32(0, 1, 2, 3);
+	const __m128i step = _mm_set1_epi32(4);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i lo = _mm_loadu_si128((const __m128i *) (prefix + i));
+		__m128i hi = _mm_loadu_si128((const __m128i *) (prefix + i + window));
+		__m128i sum = _mm_sub_epi32(hi, lo);
+		__m128i lower = _mm_cmplt_epi32(sum, best);
+
+		best = _mm_or_si128(_mm_and_si128(lower, sum), _mm_andnot_si128(lower, best));
+		bestIdx = _mm_or_si128(_mm_and_si128(lower, idx), _mm_andnot_si128(lower, bestIdx));
+		idx = _mm_add_epi32(idx, step);
+	}
+
+	int sums[4], indexes[4];
+	_mm_storeu_si128((__m128i *) sums, best);
+	_mm_storeu_si128((__m128i *) indexes, bestIdx);
+
+	reduceLanes(sums, indexes, 4, bestSum, bestIndex);
+	minWindowTail(prefix, i, count, window, bestSum, bestIndex);
+}
+
+__attribute__((target("avx2")))
+static void minWindowAvx2(const int *prefix, int count, int window, int &bestSum, int &bestIndex) {
+	__m256i best = _mm256_set1_epi32(numeric_limits<int>::max());
+	__m256i bestIdx = _mm256_setzero_si256();
+	__m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i step = _mm256_set1_epi32(8);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i lo = _mm256_loadu_si256((const __m256i *) (prefix + i));
+		__m256i hi = _mm256_loadu_si256((const __m256i *) (prefix + i + window));
+		__m256i sum = _mm256_sub_epi32(hi, lo);
+		__m256i lower = _mm256_cmpgt_epi32(best, sum);
+
+		best = _mm256_min_epi32(best, sum);
+		bestIdx = _mm256_blendv_epi8(bestIdx, idx, lower);
+		idx = _mm256_add_epi32(idx, step);
+	}
+
+	int sums[8], indexes[8];
+	_mm256_storeu_si256((__m256i *) sums, best);
+	_mm256_storeu_si256((__m256i *) indexes, bestIdx);
+
+	reduceLanes(sums, indexes, 8, bestSum, bestIndex);
+	minWindowTail(prefix, i, count, window, bestSum, bestIndex);
+}
+#endif
+
+bool isSumKernelSupported(SumKernel kernel) {
+	switch (kernel) {
+		case SUM_KERNEL_AUTO:
+		case SUM_KERNEL_SCALAR:
+			return true;
+#ifdef SUM_X86_KERNELS
+		case SUM_KERNEL_SSE:
+			return true;
+		case SUM_KERNEL_AVX2:
+			return __builtin_cpu_supports("avx2");
+#endif
+		default:
+			return false;
+	}
+}
+
+/**
+ * Defines the kernel to be used by calcSumPrefix.
+ */
+static SumKernel sumKernel = SUM_KERNEL_AUTO;
+
+void setSumKernel(SumKernel kernel) {
+	sumKernel = isSumKernelSupported(kernel) ? kernel : SUM_KERNEL_AUTO;
+}
+
+static MinWindowKernel getMinWindowKernel() {
+#ifdef SUM_X86_KERNELS
+	switch (sumKernel) {
+		case SUM_KERNEL_SCALAR:
+			return minWindowScalar;
+		case SUM_KERNEL_SSE:
+			return minWindowSse;
+		case SUM_KERNEL_AVX2:
+			return minWindowAvx2;
+		default:
+			return isSumKernelSupported(SUM_KERNEL_AVX2) ? minWindowAvx2 : minWindowSse;
+	}
+#else
+	return minWindowScalar;
+#endif
+}
+
+/*
+ * Fills bestSums and bestIndexes for the window sizes in [from, to).
+ */
+static void minWindowRange(const int *prefix, int size, int from, int to, int *bestSums, int *bestIndexes) {
+	MinWindowKernel kernel = getMinWindowKernel();
+	for (int window = from; window < to; ++window)
+		kernel(prefix, size - window + 1, window, bestSums[window - 1], bestIndexes[window - 1]);
+}
+
+/*
+ * Same result as calcSum, but the sum of each subsequence is taken from the prefix sums in O(1),
+ * so every window size costs a single (vectorized) pass: O(n^2) instead of O(n^3).
+ */
+string calcSumPrefix(int *sequence, int size) {
+	vector<int> bestSums, bestIndexes;
+	minWindowSums(sequence, size, bestSums, bestIndexes);
+
+	return buildResString(size, bestSums.data(), bestIndexes.data());
+}
+
+static void minWindowSums(int *sequence, int size, vector<int> &bestSums, vector<int> &bestIndexes) {
+	vector<int> prefix(size + 1);
+	bestSums.resize(size);
+	bestIndexes.resize(size);
+
+	buildPrefixSums(sequence, size, prefix.data());
+	minWindowRange(prefix.data(), size, 1, size + 1, bestSums.data(), bestIndexes.data());
+}
+
+void calcSum(int *sequence, int size, vector<pair<int, int>> &result) {
+	vector<int> bestSums, bestIndexes;
+	minWindowSums(sequence, size, bestSums, bestIndexes);
+
+	result.resize(size);
+	for (int i = 0; i < size; ++i)
+		result[i] = make_pair(bestSums[i], bestIndexes[i]);
+}
+
+void calcSum(int *sequence, int size, string &res) {
+	vector<int> bestSums, bestIndexes;
+	minWindowSums(sequence, size, bestSums, bestIndexes);
+
+	formatResult(size, bestSums.data(), bestIndexes.data(), res);
+}
+
+size_t calcSum(int *sequence, int size, char *buffer, size_t capacity) {
+	vector<int> bestSums, bestIndexes;
+	minWindowSums(sequence, size, bestSums, bestIndexes);
+
+	size_t length = resultLength(size, bestSums.data(), bestIndexes.data());
+	if (length <= capacity)
+		writeResult(buffer, size, bestSums.data(), bestIndexes.data());
+
+	return length;
+}
+
+/*
+ * Splits the window sizes 1..maxWindow in numThreads contiguous ranges with (about) the same total work(window).
+ * bounds gets numThreads + 1 values, range t being [bounds[t], bounds[t + 1]).
+ */
+template <typename Work>
+static void balanceRanges(int maxWindow, int numThreads, Work work, vector<int> &bounds) {
+	long long total = 0;
+	for (int window = 1; window <= maxWindow; ++window)
+		total += work(window);
+
+	long long done = 0;
+	bounds.assign(1, 1);
+	int window = 1;
+	for (int t = 1; t < numThreads; ++t) {
+		long long target = total * t / numThreads;
+		while (window <= maxWindow && done + work(window) <= target) {
+			done += work(window);
+			window++;
+		}
+		bounds.push_back(window);
+	}
+	bounds.push_back(maxWindow + 1);
+}
+
+/*
+ * The window of size m has size - m + 1 positions, so the first ranges are narrower than the last ones.
+ */
+static void balanceWindows(int size, int numThreads, vector<int> &bounds) {
+	balanceRanges(size, numThreads, [size](int window) { return (long long) (size - window + 1); }, bounds);
+}
+
+/*
+ * Multi-threaded version of calcSumPrefix: each thread takes a range of window sizes of equal total work
+ * and writes directly to its part of bestSums/bestIndexes, so the result is already in order.
+ */
+string calcSumParallel(int *sequence, int size, int numThreads) {
+	vector<int> prefix(size + 1);
+	vector<int> bestSums(size);
+	vector<int> bestIndexes(size);
+
+	buildPrefixSums(sequence, size, prefix.data());
+
+	if (numThreads > size)
+		numThreads = size;
+
+	if (numThreads <= 1) {
+		minWindowRange(prefix.data(), size, 1, size + 1, bestSums.data(), bestIndexes.data());
+		return buildResString(size, bestSums.data(), bestIndexes.data());
+	}
+
+	vector<int> bounds;
+	balanceWindows(size, numThreads, bounds);
+
+	vector<thread> threads;
+	for (int t = 1; t < numThreads; ++t)
+		threads.emplace_back(minWindowRange, prefix.data(), size, bounds[t], bounds[t + 1], bestSums.data(), bestIndexes.data());
+	minWindowRange(prefix.data(), size, bounds[0], bounds[1], bestSums.data(), bestIndexes.data());
+
+	for (thread &t : threads)
+		t.join();
+
+	return buildResString(size, bestSums.data(), bestIndexes.data());
+}
+
+void buildPrefixSums(const int *sequence, int size, int *prefix) {
+	prefix[0] = 0;
+	for (int i = 0; i < size; ++i)
+		prefix[i + 1] = (int) ((unsigned) prefix[i] + (unsigned) sequence[i]);
+}
+
+/*
+ * Values of a stream are read in blocks of this many values, so only the prefix sums grow with the input.
+ */
+static const size_t STREAM_BLOCK_VALUES = 1 << 16;
+
+static size_t valueWidth(SumValueType type) {
+	return type == SUM_INT64 ? sizeof(int64_t) : sizeof(int32_t);
+}
+
+/*
+ * Appends to the prefix sums the count values of the given type stored (native byte order) in data.
+ * As in buildPrefixSums, the sums wrap around instead of overflowing.
+ */
+static void appendPrefixSums(const char *data, size_t count, SumValueType type, vector<long long> &prefix) {
+	unsigned long long sum = prefix.back();
+
+	if (type == SUM_INT64) {
+		for (size_t i = 0; i < count; ++i) {
+			int64_t value;
+			memcpy(&value, data + i * sizeof(int64_t), sizeof(int64_t));
+			sum += value;
+			prefix.push_back((long long) sum);
+		}
+	} else {
+		for (size_t i = 0; i < count; ++i) {
+			int32_t value;
+			memcpy(&value, data + i * sizeof(int32_t), sizeof(int32_t));
+			sum += value;
+			prefix.push_back((long long) sum);
+		}
+	}
+}
+
+static void minWindowScalar64(const long long *prefix, long long count, long long window, long long &bestSum, long long &bestIndex) {
+	bestSum = numeric_limits<long long>::max();
+	bestIndex = 0;
+
+	for (long long i = 0; i < count; ++i) {
+		long long sum = (long long) ((unsigned long long) prefix[i + window] - (unsigned long long) prefix[i]);
+		if (sum < bestSum) {
+			bestSum = sum;
+			bestIndex = i;
+		}
+	}
+}
+
+/*
+ * Does the calcSum work with 64 bit prefix sums that were already read from the input.
+ */
+static string calcSumFromPrefix(const vector<long long> &prefix) {
+	long long size = prefix.size() - 1;
+	vector<long long> bestSums(size);
+	vector<long long> bestIndexes(size);
+
+	for (long long window = 1; window <= size; ++window)
+		minWindowScalar64(prefix.data(), size - window + 1, window, bestSums[window - 1], bestIndexes[window - 1]);
+
+	return buildResString(size, bestSums.data(), bestIndexes.data());
+}
+
+string calcSumStream(istream &in, SumValueType type) {
+	const size_t width = valueWidth(type);
+	vector<char> block(STREAM_BLOCK_VALUES * width);
+	vector<long long> prefix(1, 0);
+	size_t pending = 0; // bytes of an incomplete value left at the start of the block
+
+	while (in) {
+		in.read(block.data() + pending, block.size() - pending);
+		size_t bytes = pending + in.gcount();
+		size_t count = bytes / width;
+
+		appendPrefixSums(block.data(), count, type, prefix);
+
+		pending = bytes - count * width;
+		memmove(block.data(), block.data() + count * width, pending);
+	}
+
+	if (pending != 0 || in.bad()) // truncated value or read error
+		return "-";
+
+	return calcSumFromPrefix(prefix);
+}
+
+string calcSumFile(const string &name, SumValueType type) {
+#ifdef SUM_MMAP
+	int fd = open(name.c_str(), O_RDONLY);
+	if (fd < 0)
+		return "-";
+
+	struct stat info;
+	if (fstat(fd, &info) < 0 || info.st_size % valueWidth(type) != 0) {
+		close(fd);
+		return "-";
+	}
+
+	size_t bytes = info.st_size;
+	size_t count = bytes / valueWidth(type);
+	vector<long long> prefix(1, 0);
+
+	if (bytes > 0) {
+		void *data = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			close(fd);
+			return "-";
+		}
+		madvise(data, bytes, MADV_SEQUENTIAL);
+
+		prefix.reserve(count + 1);
+		appendPrefixSums((const char *) data, count, type, prefix);
+
+		munmap(data, bytes);
+	}
+	close(fd);
+
+	return calcSumFromPrefix(prefix);
+#else
+	ifstream file(name, ios::binary);
+	if (!file.is_open())
+		return "-";
+	return calcSumStream(file, type);
+#endif
+}
+
+/*
+ * Generic element types. The integer windows are scanned over the narrowest prefix sums their sums are guaranteed
+ * to fit in, given the largest absolute value of the sequence: a window of m values sums to at most m * maxAbs.
+ * The real ones are scanned over prefix sums in the accumulator type.
+ */
+
+static void minWindowScalar16(const uint16_t *prefix, int count, int window, int &bestSum, int &bestIndex) {
+	bestSum = numeric_limits<int>::max();
+	bestIndex = 0;
+
+	for (int i = 0; i < count; ++i) {
+		int sum = (int16_t) (uint16_t) (prefix[i + window] - prefix[i]);
+		if (sum < bestSum) {
+			bestSum = sum;
+			bestIndex = i;
+		}
+	}
+}
+
+template <typename Real>
+static void minWindowScalarReal(const Real *prefix, int count, int window, Real &bestSum, int &bestIndex) {
+	bestSum = numeric_limits<Real>::infinity();
+	bestIndex = 0;
+
+	for (int i = 0; i < count; ++i) {
+		Real sum = prefix[i + window] - prefix[i];
+		if (sum < bestSum) {
+			bestSum = sum;
+			bestIndex = i;
+		}
+	}
+}
+
+#ifdef SUM_X86_KERNELS
+/*
+ * Same as reduceLanes, for the lanes of any width (the tail is then done by the caller).
+ */
+template <typename S, typename I>
+static void reduceLanesOf(const S *sums, const I *indexes, int lanes, S &bestSum, int &bestIndex) {
+	for (int lane = 0; lane < lanes; ++lane) {
+		if (sums[lane] < bestSum || (sums[lane] == bestSum && indexes[lane] < bestIndex)) {
+			bestSum = sums[lane];
+			bestIndex = (int) indexes[lane];
+		}
+	}
+}
+
+/*
+ * Sixteen 16 bit windows per instruction. Indexes don't fit in 16 bits, so each lane counts its iterations
+ * instead, in blocks short enough for the counter, and the blocks are reduced one by one.
+ */
+__attribute__((target("avx2")))
+static void minWindowAvx2x16(const uint16_t *prefix, int count, int window, int &bestSum, int &bestIndex) {
+	const int BLOCK = 16 * numeric_limits<int16_t>::max();
+	bestSum = numeric_limits<int>::max();
+	bestIndex = 0;
+
+	int i = 0;
+	while (count - i >= 16) {
+		int end = min(i + BLOCK, count - (count - i) % 16);
+		__m256i best = _mm256_set1_epi16(numeric_limits<int16_t>::max());
+		__m256i bestIter = _mm256_setzero_si256();
+		__m256i iter = _mm256_setzero_si256();
+		const __m256i one = _mm256_set1_epi16(1);
+
+		for (int j = i; j < end; j += 16) {
+			__m256i lo = _mm256_loadu_si256((const __m256i *) (prefix + j));
+			__m256i hi = _mm256_loadu_si256((const __m256i *) (prefix + j + window));
+			__m256i sum = _mm256_sub_epi16(hi, lo);
+			__m256i lower = _mm256_cmpgt_epi16(best, sum);
+
+			best = _mm256_min_epi16(best, sum);
+			bestIter = _mm256_blendv_epi8(bestIter, iter, lower);
+			iter = _mm256_add_epi16(iter, one);
+		}
+
+		int16_t sums[16], iters[16];
+		_mm256_storeu_si256((__m256i *) sums, best);
+		_mm256_storeu_si256((__m256i *) iters, bestIter);
+
+		int lanes[16], indexes[16];
+		for (int lane = 0; lane < 16; ++lane) {
+			lanes[lane] = sums[lane];
+			indexes[lane] = i + iters[lane] * 16 + lane;
+		}
+		reduceLanesOf(lanes, indexes, 16, bestSum, bestIndex);
+		i = end;
+	}
+
+	for (; i < count; ++i) {
+		int sum = (int16_t) (uint16_t) (prefix[i + window] - prefix[i]);
+		if (sum < bestSum) {
+			bestSum = sum;
+			bestIndex = i;
+		}
+	}
+}
+
+__attribute__((target("avx2")))
+static void minWindowAvx2x64(const long long *prefix, int count, int window, long long &bestSum, int &bestIndex) {
+	__m256i best = _mm256_set1_epi64x(numeric_limits<long long>::max());
+	__m256i bestIdx = _mm256_setzero_si256();
+	__m256i idx = _mm256_setr_epi64x(0, 1, 2, 3);
+	const __m256i step = _mm256_set1_epi64x(4);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m256i lo = _mm256_loadu_si256((const __m256i *) (prefix + i));
+		__m256i hi = _mm256_loadu_si256((const __m256i *) (prefix + i + window));
+		__m256i sum = _mm256_sub_epi64(hi, lo);
+		__m256i lower = _mm256_cmpgt_epi64(best, sum);
+
+		best = _mm256_blendv_epi8(best, sum, lower);
+		bestIdx = _mm256_blendv_epi8(bestIdx, idx, lower);
+		idx = _mm256_add_epi64(idx, step);
+	}
+
+	long long sums[4], indexes[4];
+	_mm256_storeu_si256((__m256i *) sums, best);
+	_mm256_storeu_si256((__m256i *) indexes, bestIdx);
+
+	bestSum = numeric_limits<long long>::max();
+	bestIndex = 0;
+	reduceLanesOf(sums, indexes, 4, bestSum, bestIndex);
+
+	for (; i < count; ++i) {
+		long long sum = (long long) ((unsigned long long) prefix[i + window] - (unsigned long long) prefix[i]);
+		if (sum < bestSum) {
+			bestSum = sum;
+			bestIndex = i;
+		}
+	}
+}
+
+__attribute__((target("avx2")))
+static void minWindowAvx2Real(const float *prefix, int count, int window, float &bestSum, int &bestIndex) {
+	__m256 best = _mm256_set1_ps(numeric_limits<float>::infinity());
+	__m256i bestIdx = _mm256_setzero_si256();
+	__m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i step = _mm256_set1_epi32(8);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 sum = _mm256_sub_ps(_mm256_loadu_ps(prefix + i + window), _mm256_loadu_ps(prefix + i));
+		__m256 lower = _mm256_cmp_ps(sum, best, _CMP_LT_OQ);
+
+		best = _mm256_blendv_ps(best, sum, lower);
+		bestIdx = _mm256_blendv_epi8(bestIdx, idx, _mm256_castps_si256(lower));
+		idx = _mm256_add_epi32(idx, step);
+	}
+
+	float sums[8];
+	int indexes[8];
+	_mm256_storeu_ps(sums, best);
+	_mm256_storeu_si256((__m256i *) indexes, bestIdx);
+
+	bestSum = numeric_limits<float>::infinity();
+	bestIndex = 0;
+	reduceLanesOf(sums, indexes, 8, bestSum, bestIndex);
+
+	for (; i < count; ++i) {
+		float sum = prefix[i + window] - prefix[i];
+		if (sum < bestSum) {
+			bestSum = sum;
+			bestIndex = i;
+		}
+	}
+}
+
+__attribute__((target("avx2")))
+static void minWindowAvx2Real(const double *prefix, int count, int window, double &bestSum, int &bestIndex) {
+	__m256d best = _mm256_set1_pd(numeric_limits<double>::infinity());
+	__m256i bestIdx = _mm256_setzero_si256();
+	__m256i idx = _mm256_setr_epi64x(0, 1, 2, 3);
+	const __m256i step = _mm256_set1_epi64x(4);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m256d sum = _mm256_sub_pd(_mm256_loadu_pd(prefix + i + window), _mm256_loadu_pd(prefix + i));
+		__m256d lower = _mm256_cmp_pd(sum, best, _CMP_LT_OQ);
+
+		best = _mm256_blendv_pd(best, sum, lower);
+		bestIdx = _mm256_blendv_epi8(bestIdx, idx, _mm256_castpd_si256(lower));
+		idx = _mm256_add_epi64(idx, step);
+	}
+
+	double sums[4];
+	long long indexes[4];
+	_mm256_storeu_pd(sums, best);
+	_mm256_storeu_si256((__m256i *) indexes, bestIdx);
+
+	bestSum = numeric_limits<double>::infinity();
+	bestIndex = 0;
+	reduceLanesOf(sums, indexes, 4, bestSum, bestIndex);
+
+	for (; i < count; ++i) {
+		double sum = prefix[i + window] - prefix[i];
+		if (sum < bestSum) {
+			bestSum = sum;
+			bestIndex = i;
+		}
+	}
+}
+#endif
+
+/*
+ * Whether the kernels of the other element types use AVX2: they follow setSumKernel, SSE meaning scalar for them.
+ */
+static bool useAvx2Kernels() {
+#ifdef SUM_X86_KERNELS
+	return sumKernel == SUM_KERNEL_AVX2 || (sumKernel == SUM_KERNEL_AUTO && isSumKernelSupported(SUM_KERNEL_AVX2));
+#else
+	return false;
+#endif
+}
+
+typedef void (*MinWindowKernel16)(const uint16_t *prefix, int count, int window, int &bestSum, int &bestIndex);
+typedef void (*MinWindowKernel64)(const long long *prefix, int count, int window, long long &bestSum, int &bestIndex);
+
+static void minWindowScalar64(const long long *prefix, int count, int window, long long &bestSum, int &bestIndex) {
+	long long index;
+	minWindowScalar64(prefix, count, window, bestSum, index);
+	bestIndex = (int) index;
+}
+
+static MinWindowKernel16 getMinWindowKernel16() {
+#ifdef SUM_X86_KERNELS
+	if (useAvx2Kernels())
+		return minWindowAvx2x16;
+#endif
+	return minWindowScalar16;
+}
+
+static MinWindowKernel64 getMinWindowKernel64() {
+#ifdef SUM_X86_KERNELS
+	if (useAvx2Kernels())
+		return minWindowAvx2x64;
+#endif
+	return minWindowScalar64;
+}
+
+template <typename Real>
+static void (*getMinWindowKernelReal())(const Real *, int, int, Real &, int &) {
+#ifdef SUM_X86_KERNELS
+	if (useAvx2Kernels())
+		return minWindowAvx2Real;
+#endif
+	return minWindowScalarReal<Real>;
+}
+
+template <typename T, typename Acc>
+static void calcSumGeneric(const T *sequence, int size, vector<pair<Acc, int>> &result, true_type /* integers */) {
+	unsigned long long maxAbs = 0;
+	for (int i = 0; i < size; ++i) {
+		long long value = sequence[i];
+		maxAbs = max(maxAbs, value < 0 ? 0ULL - (unsigned long long) value : (unsigned long long) value);
+	}
+
+	// windows up to these sizes have sums that fit in 16 and 32 bits
+	long long limit16 = maxAbs == 0 ? size : min((long long) size, (long long) (numeric_limits<int16_t>::max() / maxAbs));
+	long long limit32 = maxAbs == 0 ? size : min((long long) size, (long long) (numeric_limits<int>::max() / maxAbs));
+
+	vector<uint16_t> prefix16(limit16 > 0 ? size + 1 : 0);
+	vector<int> prefix32(limit32 > limit16 ? size + 1 : 0);
+	vector<long long> prefix64(size > limit32 ? size + 1 : 0);
+
+	unsigned long long sum = 0;
+	for (int i = 0; i <= size; ++i) {
+		if (!prefix16.empty())
+			prefix16[i] = (uint16_t) sum;
+		if (!prefix32.empty())
+			prefix32[i] = (int) (unsigned) sum;
+		if (!prefix64.empty())
+			prefix64[i] = (long long) sum;
+		if (i < size)
+			sum += (unsigned long long) (long long) sequence[i];
+	}
+
+	MinWindowKernel16 kernel16 = getMinWindowKernel16();
+	MinWindowKernel kernel32 = getMinWindowKernel();
+	MinWindowKernel64 kernel64 = getMinWindowKernel64();
+	result.resize(size);
+
+	for (int window = 1; window <= size; ++window) {
+		int count = size - window + 1;
+		int index;
+
+		if (window <= limit16) {
+			int best;
+			kernel16(prefix16.data(), count, window, best, index);
+			result[window - 1] = make_pair((Acc) best, index);
+		} else if (window <= limit32) {
+			int best;
+			kernel32(prefix32.data(), count, window, best, index);
+			result[window - 1] = make_pair((Acc) best, index);
+		} else {
+			long long best;
+			kernel64(prefix64.data(), count, window, best, index);
+			result[window - 1] = make_pair((Acc) best, index);
+		}
+	}
+}
+
+template <typename T, typename Acc>
+static void calcSumGeneric(const T *sequence, int size, vector<pair<Acc, int>> &result, false_type /* reals */) {
+	vector<Acc> prefix(size + 1);
+	prefix[0] = 0;
+	for (int i = 0; i < size; ++i)
+		prefix[i + 1] = prefix[i] + (Acc) sequence[i];
+
+	void (*kernel)(const Acc *, int, int, Acc &, int &) = getMinWindowKernelReal<Acc>();
+	result.resize(size);
+	for (int window = 1; window <= size; ++window) {
+		Acc best;
+		int index;
+		kernel(prefix.data(), size - window + 1, window, best, index);
+		result[window - 1] = make_pair(best, index);
+	}
+}
+
+template <typename T, typename Acc>
+void calcSum(const T *sequence, int size, vector<pair<Acc, int>> &result) {
+	static_assert(is_integral<T>::value == is_integral<Acc>::value, "integers are accumulated as integers, reals as reals");
+	static_assert(sizeof(Acc) >= sizeof(T), "the accumulator can't be narrower than the elements");
+
+	calcSumGeneric(sequence, size, result, is_integral<T>());
+}
+
+template void calcSum<int16_t, int32_t>(const int16_t *, int, vector<pair<int32_t, int>> &);
+template void calcSum<int16_t, int64_t>(const int16_t *, int, vector<pair<int64_t, int>> &);
+template void calcSum<int32_t, int32_t>(const int32_t *, int, vector<pair<int32_t, int>> &);
+template void calcSum<int32_t, int64_t>(const int32_t *, int, vector<pair<int64_t, int>> &);
+template void calcSum<int64_t, int64_t>(const int64_t *, int, vector<pair<int64_t, int>> &);
+template void calcSum<float, float>(const float *, int, vector<pair<float, int>> &);
+template void calcSum<float, double>(const float *, int, vector<pair<double, int>> &);
+template void calcSum<double, double>(const double *, int, vector<pair<double, int>> &);
+
+/*
+ * Two dimensional windows. With the summed-area table S (S[r][c] = sum of the values above and to the left of (r, c)),
+ * the k x k window at (r, c) sums to S[r + k][c + k] - S[r + k][c] - S[r][c + k] + S[r][c]: for a fixed r, the sums
+ * of a whole row of windows come from two rows of S, top = S[r] and bottom = S[r + k], as a vectorized scan.
+ * As in the one dimensional case, the table is kept in 32 bits (wrapping) while k^2 * maxAbs fits in an int.
+ */
+
+/*
+ * Columns per tile: the k + 1 rows of the table that a tile of windows reads stay in cache between one
+ * row of windows and the next ones (bottom becomes top k rows later).
+ */
+static const int SUM_2D_TILE = 1024;
+
+template <typename S>
+static void minRowScalar(const S *top, const S *bottom, int count, int k, long long &bestSum, int &bestIndex) {
+	typedef typename make_unsigned<S>::type U;
+	bestSum = numeric_limits<long long>::max();
+	bestIndex = 0;
+
+	for (int c = 0; c < count; ++c) {
+		S sum = (S) ((U) bottom[c + k] - (U) bottom[c] - (U) top[c + k] + (U) top[c]);
+		if (sum < bestSum) {
+			bestSum = sum;
+			bestIndex = c;
+		}
+	}
+}
+
+#ifdef SUM_X86_KERNELS
+__attribute__((target("avx2")))
+static void minRowAvx2(const int *top, const int *bottom, int count, int k, long long &bestSum, int &bestIndex) {
+	__m256i best = _mm256_set1_epi32(numeric_limits<int>::max());
+	__m256i bestIdx = _mm256_setzero_si256();
+	__m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i step = _mm256_set1_epi32(8);
+
+	int c = 0;
+	for (; c + 8 <= count; c += 8) {
+		__m256i right = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *) (bottom + c + k)),
+				_mm256_loadu_si256((const __m256i *) (top + c + k)));
+		__m256i left = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *) (bottom + c)),
+				_mm256_loadu_si256((const __m256i *) (top + c)));
+		__m256i sum = _mm256_sub_epi32(right, left);
+		__m256i lower = _mm256_cmpgt_epi32(best, sum);
+
+		best = _mm256_min_epi32(best, sum);
+		bestIdx = _mm256_blendv_epi8(bestIdx, idx, lower);
+		idx = _mm256_add_epi32(idx, step);
+	}
+
+	int sums[8], indexes[8];
+	_mm256_storeu_si256((__m256i *) sums, best);
+	_mm256_storeu_si256((__m256i *) indexes, bestIdx);
+
+	int best32 = numeric_limits<int>::max(), index = 0;
+	reduceLanesOf(sums, indexes, 8, best32, index);
+	bestSum = best32;
+	bestIndex = index;
+
+	for (; c < count; ++c) {
+		int sum = (int) ((unsigned) bottom[c + k] - (unsigned) bottom[c] - (unsigned) top[c + k] + (unsigned) top[c]);
+		if (sum < bestSum) {
+			bestSum = sum;
+			bestIndex = c;
+		}
+	}
+}
+
+__attribute__((target("avx2")))
+static void minRowAvx2(const long long *top, const long long *bottom, int count, int k, long long &bestSum, int &bestIndex) {
+	__m256i best = _mm256_set1_epi64x(numeric_limits<long long>::max());
+	__m256i bestIdx = _mm256_setzero_si256();
+	__m256i idx = _mm256_setr_epi64x(0, 1, 2, 3);
+	const __m256i step = _mm256_set1_epi64x(4);
+
+	int c = 0;
+	for (; c + 4 <= count; c += 4) {
+		__m256i right = _mm256_sub_epi64(_mm256_loadu_si256((const __m256i *) (bottom + c + k)),
+				_mm256_loadu_si256((const __m256i *) (top + c + k)));
+		__m256i left = _mm256_sub_epi64(_mm256_loadu_si256((const __m256i *) (bottom + c)),
+				_mm256_loadu_si256((const __m256i *) (top + c)));
+		__m256i sum = _mm256_sub_epi64(right, left);
+		__m256i lower = _mm256_cmpgt_epi64(best, sum);
+
+		best = _mm256_blendv_epi8(best, sum, lower);
+		bestIdx = _mm256_blendv_epi8(bestIdx, idx, lower);
+		idx = _mm256_add_epi64(idx, step);
+	}
+
+	long long sums[4], indexes[4];
+	_mm256_storeu_si256((__m256i *) sums, best);
+	_mm256_storeu_si256((__m256i *) indexes, bestIdx);
+
+	bestSum = numeric_limits<long long>::max();
+	bestIndex = 0;
+	reduceLanesOf(sums, indexes, 4, bestSum, bestIndex);
+
+	for (; c < count; ++c) {
+		long long sum = (long long) ((unsigned long long) bottom[c + k] - (unsigned long long) bottom[c]
+				- (unsigned long long) top[c + k] + (unsigned long long) top[c]);
+		if (sum < bestSum) {
+			bestSum = sum;
+			bestIndex = c;
+		}
+	}
+}
+#endif
+
+template <typename S>
+static void (*getMinRowKernel())(const S *, const S *, int, int, long long &, int &) {
+#ifdef SUM_X86_KERNELS
+	if (useAvx2Kernels())
+		return minRowAvx2;
+#endif
+	return minRowScalar<S>;
+}
+
+/*
+ * Minimum k x k window over the summed-area table (width cols + 1), tile by tile of columns.
+ * Ties go to the first window in row-major order, like calcSum does in one dimension.
+ */
+template <typename S>
+static MinWindow2D minWindow2D(const S *table, int rows, int cols, int k) {
+	void (*kernel)(const S *, const S *, int, int, long long &, int &) = getMinRowKernel<S>();
+	const int width = cols + 1;
+	const int positions = cols - k + 1;
+
+	MinWindow2D best = {numeric_limits<long long>::max(), 0, 0};
+	bool found = false;
+
+	for (int from = 0; from < positions; from += SUM_2D_TILE) {
+		int count = min(SUM_2D_TILE, positions - from);
+		for (int r = 0; r + k <= rows; ++r) {
+			long long sum;
+			int index;
+			kernel(table + (size_t) r * width + from, table + (size_t) (r + k) * width + from, count, k, sum, index);
+
+			int c = from + index;
+			if (!found || sum < best.sum || (sum == best.sum && (r < best.row || (r == best.row && c < best.col)))) {
+				best.sum = sum;
+				best.row = r;
+				best.col = c;
+				found = true;
+			}
+		}
+	}
+
+	return best;
+}
+
+void calcSum2D(const int *matrix, int rows, int cols, vector<MinWindow2D> &result, int numThreads) {
+	int maxWindow = min(rows, cols);
+	result.assign(max(maxWindow, 0), MinWindow2D());
+	if (maxWindow <= 0)
+		return;
+
+	unsigned long long maxAbs = 0;
+	for (size_t i = 0; i < (size_t) rows * cols; ++i)
+		maxAbs = max(maxAbs, (unsigned long long) (matrix[i] < 0 ? -(long long) matrix[i] : matrix[i]));
+
+	// windows up to this size have sums that fit in an int
+	int limit32 = maxWindow;
+	while (limit32 > 0 && (unsigned long long) limit32 * limit32 * maxAbs > (unsigned long long) numeric_limits<int>::max())
+		limit32--;
+
+	const int width = cols + 1;
+	vector<int> table32(limit32 > 0 ? (size_t) (rows + 1) * width : 0);
+	vector<long long> table64(limit32 < maxWindow ? (size_t) (rows + 1) * width : 0);
+
+	vector<unsigned long long> above(width, 0); // row r - 1 of the table
+	for (int r = 0; r <= rows; ++r) {
+		unsigned long long line = 0;
+		for (int c = 0; c <= cols; ++c) {
+			if (r > 0 && c > 0) {
+				line += (unsigned long long) (long long) matrix[(size_t) (r - 1) * cols + c - 1];
+				above[c] += line;
+			}
+			if (!table32.empty())
+				table32[(size_t) r * width + c] = (int) (unsigned) above[c];
+			if (!table64.empty())
+				table64[(size_t) r * width + c] = (long long) above[c];
+		}
+	}
+
+	auto windowRange = [&](int from, int to) {
+		for (int k = from; k < to; ++k)
+			result[k - 1] = k <= limit32 ? minWindow2D(table32.data(), rows, cols, k) : minWindow2D(table64.data(), rows, cols, k);
+	};
+
+	numThreads = max(1, min(numThreads, maxWindow));
+	if (numThreads == 1) {
+		windowRange(1, maxWindow + 1);
+		return;
+	}
+
+	vector<int> bounds;
+	balanceRanges(maxWindow, numThreads, [rows, cols](int k) { return (long long) (rows - k + 1) * (cols - k + 1); }, bounds);
+
+	vector<thread> threads;
+	for (int t = 1; t < numThreads; ++t)
+		threads.emplace_back(windowRange, bounds[t], bounds[t + 1]);
+	windowRange(bounds[0], bounds[1]);
+
+	for (thread &t : threads)
+		t.join();
 }
 
 string buildResString(int size, const int *bestSums, const int *bestIndexes) {
-    string res = "";
-    for (int i = 0; i < size; ++i)
-        res += to_string(bestSums[i]) + "," + to_string(bestIndexes[i]) + ";";
+    string res;
+    formatResult(size, bestSums, bestIndexes, res);
+    return res;
+}
+
+string buildResString(long long size, const long long *bestSums, const long long *bestIndexes) {
+    string res;
+    formatResult(size, bestSums, bestIndexes, res);
     return res;
 }
 
@@ -98,35 +1106,27 @@ int getSum(const int *sequence, int iteration, int amount) {
 
 void benchmark(string name, int maxSize, int qtMeasurements) {
 	const int INCREMENTAL = 10;
+	const int WARMUPS = 3;
 
-	ofstream file;
-	file.open(name);
-	file << "Size,Average (millis)\n";
+	BenchmarkReport report;
+	int numThreads = max(1u, thread::hardware_concurrency());
+	volatile size_t sink = 0; // keeps the compiler from discarding the results
 
 	srand (time(NULL));
 
-	int sum;
-	double avg;
 	for (int size = INCREMENTAL; size < maxSize; size += INCREMENTAL) {
-		sum = 0;
-		for (int i = 0; i < qtMeasurements; ++i) {
-			int *arr = (int*)malloc(sizeof(int) * size);
-
-			for (int j = 0; j < size; j++)
-				arr[j] = rand() % size + 1;
+		vector<int> arr(size);
+		for (int j = 0; j < size; j++)
+			arr[j] = rand() % size + 1;
 
-			auto start = std::chrono::high_resolution_clock::now();
-			calcSum(arr, size);
-			auto finish = std::chrono::high_resolution_clock::now();
-			sum += chrono::duration_cast<chrono::milliseconds>(finish - start).count();
-
-			free(arr);
-		}
-		avg = (double) sum / qtMeasurements;
-		file << size << "," << avg << "\n";
+		report.add(measure("calcSum", size, [&]() { sink += calcSum(arr.data(), size).size(); }, WARMUPS, qtMeasurements));
+		report.add(measure("calcSum2", size, [&]() { sink += calcSum2(arr.data(), size).size(); }, WARMUPS, qtMeasurements));
+		report.add(measure("calcSumPrefix", size, [&]() { sink += calcSumPrefix(arr.data(), size).size(); }, WARMUPS, qtMeasurements));
+		report.add(measure("calcSumParallel", size, [&]() { sink += calcSumParallel(arr.data(), size, numThreads).size(); }, WARMUPS, qtMeasurements));
 	}
 
-	file.close();
+	report.writeCsv(name);
+	report.writeJson(name.substr(0, name.find_last_of('.')) + ".json");
 }
 
 void updateValues(int *values, int iteration, int qtNumbers, int &bestIndex, int &bestSum) {
@@ -152,7 +1152,10 @@ string &fillFirstIteration(const int *sequence, int size, int *values, string &r
 		}
 	}
 
-	res += to_string(bestSum) + "," + to_string(bestIndex) + ";";
+	appendInt(res, bestSum);
+	res += ',';
+	appendInt(res, bestIndex);
+	res += ';';
 	return res;
 }
 
@@ -5,7 +5,11 @@
 #ifndef SUM_H_
 #define SUM_H_
 
+#include <cstdint>
+#include <istream>
 #include <string>
+#include <utility>
+#include <vector>
 using namespace std;
 
 
@@ -23,9 +27,109 @@ using namespace std;
  */
 string calcSum(int* sequence, int size);
 
+/* Versões de calcSum para quem não precisa de construir uma nova string.
+ * Calculam o mesmo resultado com o algoritmo de calcSumPrefix.
+ *
+ * result - recebe, para cada m, o par (s, i), sem formatação nenhuma
+ * res - recebe o mesmo texto que calcSum devolve, reaproveitando a capacidade que já tiver
+ * buffer - recebe o mesmo texto (sem terminador), se couber nos capacity caracteres; caso contrário não é alterado.
+ *          Devolve o tamanho do texto, que permite saber quanto espaço é preciso.
+ */
+void calcSum(int* sequence, int size, vector<pair<int, int>> &result);
+void calcSum(int* sequence, int size, string &res);
+size_t calcSum(int* sequence, int size, char *buffer, size_t capacity);
+
+/* Versão genérica de calcSum, para sequências de int16_t, int32_t, int64_t, float ou double, com as somas
+ * no tipo Acc: int32_t ou int64_t para inteiros (não mais estreito do que T), float ou double para reais.
+ * result recebe, para cada m, o par (s, i), como na versão de int.
+ *
+ * Com inteiros, as somas são exatas sempre que cabem em 64 bits, sem overflow silencioso pelo meio (só no fim
+ * são convertidas para Acc). Cada tamanho m é percorrido com as somas prefixas na largura mais estreita em que
+ * as somas de m valores garantidamente cabem (m * maior valor absoluto): 16 bits, com 16 janelas por instrução
+ * AVX2 e metade da memória do caminho de int, depois 32 e por fim 64 bits.
+ * Com reais, as somas são diferenças de somas prefixas acumuladas em Acc, por isso têm o erro de arredondamento
+ * dessas somas (acumular float em double elimina-o quase todo).
+ */
+template <typename T, typename Acc>
+void calcSum(const T *sequence, int size, vector<pair<Acc, int>> &result);
+
+/* Janela k x k de soma mínima numa matriz: soma e posição (linha e coluna do canto superior esquerdo). */
+struct MinWindow2D {
+	long long sum;
+	int row;
+	int col;
+};
+
+/* Versão de calcSum para matrizes: para cada k (1 <= k <= min(rows, cols)), a janela k x k de soma mínima
+ * (a primeira, percorrendo as linhas de cima para baixo, se houver várias).
+ * Constrói uma única vez a tabela de somas acumuladas (summed-area table), que dá a soma de qualquer janela em O(1),
+ * e percorre-a com instruções vetoriais, em blocos de colunas que cabem na cache. Os tamanhos de janela são divididos
+ * por numThreads threads, com a mesma quantidade de trabalho. Complexidade O(rows * cols * min(rows, cols)).
+ *
+ * Argumentos:
+ * 	matrix - Array com a matriz, linha a linha
+ * 	rows, cols - Dimensões da matriz
+ * 	result - recebe, na posição k - 1, a janela de soma mínima de tamanho k
+ */
+void calcSum2D(const int *matrix, int rows, int cols, vector<MinWindow2D> &result, int numThreads = 1);
+
+/* Igual a calcSum, mas acumula as somas de cada m a partir das de m - 1, num único array de n valores. Complexidade O(n^2).
+ */
+string calcSum2(int* sequence, int size);
+
+/* Kernels disponíveis para o cálculo do mínimo de cada janela em calcSumPrefix.
+ * SUM_KERNEL_AUTO escolhe, em tempo de execução, o melhor suportado pelo processador.
+ */
+enum SumKernel {
+	SUM_KERNEL_AUTO,
+	SUM_KERNEL_SCALAR,
+	SUM_KERNEL_SSE,
+	SUM_KERNEL_AVX2
+};
+
+/* Igual a calcSum, mas calcula as somas a partir de um único array de somas prefixas,
+ * percorrendo-o com instruções vetoriais (AVX2/SSE) quando disponíveis. Complexidade O(n^2).
+ */
+string calcSumPrefix(int* sequence, int size);
+
+/* Versão multi-thread de calcSumPrefix. Os tamanhos de subsequência são divididos por numThreads threads
+ * em intervalos com a mesma quantidade total de trabalho. Devolve exatamente a mesma string que calcSum.
+ */
+string calcSumParallel(int* sequence, int size, int numThreads);
+
+/* Tipo dos valores de uma sequência lida em binário (inteiros com sinal, na ordem de bytes da máquina).
+ */
+enum SumValueType {
+	SUM_INT32,
+	SUM_INT64
+};
+
+/* Igual a calcSum, mas lê a sequência de um stream binário em blocos, sem precisar de a ter toda em memória.
+ * Só guarda, no heap, as somas prefixas (64 bits) e o melhor valor para cada m.
+ *
+ * Devolve:
+ * A mesma string que calcSum, ou "-" se a leitura falhar ou o stream terminar a meio de um valor.
+ */
+string calcSumStream(istream &in, SumValueType type);
+
+/* Igual a calcSumStream, mas mapeia o ficheiro binário name em memória (mmap) e lê-o diretamente, sem cópia.
+ */
+string calcSumFile(const string &name, SumValueType type);
+
+/* Define o kernel usado por calcSumPrefix. Um kernel não suportado pelo processador é ignorado (usa SUM_KERNEL_AUTO).
+ */
+void setSumKernel(SumKernel kernel);
+
+/* Indica se o kernel pode ser usado no processador atual.
+ */
+bool isSumKernelSupported(SumKernel kernel);
+
 /*
- * Testa extensivamente o algoritmo, exportando um csv com duas colunas, uma onde estará o numero de elementos do array
- * e outra com a média de tempo para o numero dado.
+ * Testa extensivamente os algoritmos (calcSum, calcSum2, calcSumPrefix e calcSumParallel), lado a lado.
+ * Para cada tamanho gera uma sequência aleatória (fora da medição), faz algumas execuções de aquecimento
+ * e mede cada execução com resolução de nanossegundos.
+ * Exporta um csv (e um json com o mesmo nome) com, para cada algoritmo e tamanho, o mínimo, a média,
+ * a mediana, os percentis 95 e 99 dos tempos e o throughput.
  *
  * Argumentos:
  *  name - Nome do csv
@@ -1,11 +1,17 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <fstream>
+#include <sstream>
+#include <thread>
 
 //#include "Defs.h"
 #include "../src/Factorial.h"
 #include "../src/Change.h"
 #include "../src/Sum.h"
 #include "../src/Partitioning.h"
+#include "../src/Benchmark.h"
+#include "../src/BigInt.h"
+#include "../src/Ntt.h"
 
 using namespace std;
 using testing::Eq;
@@ -19,6 +25,80 @@ TEST(CAL_FP01, FactorialTest) {
 }
 
 
+TEST(CAL_FP01, FactorialBigTest) {
+	EXPECT_EQ("1", factorialBig(0).toString());
+	EXPECT_EQ("3628800", factorialBig(10).toString());
+	EXPECT_EQ("2432902008176640000", factorialBig(20).toString());
+	EXPECT_EQ("93326215443944152681699238856266700490715968264381621468592963895217599993229915608941463976156518286253697920827223758251185210916864000000000000000000000000",
+			  factorialBig(100).toString());
+
+	BigInt f = factorialBig(5000);
+	EXPECT_EQ(16326u, f.numDigits());
+	EXPECT_EQ(f, factorialBig(5000, 4));
+
+	// building it one factor at a time
+	BigInt slow(1);
+	for (uint32_t i = 2; i <= 5000; i++)
+		slow *= i;
+	EXPECT_EQ(slow, f);
+	EXPECT_EQ(f, BigInt(f.toString()));
+
+	// (10^n - 1)^2 = 99..9800..01, big enough to go through Karatsuba and through the NTT
+	for (int n : {2000, 20000}) {
+		BigInt nines(string(n, '9'));
+		string square = string(n - 1, '9') + "8" + string(n - 1, '0') + "1";
+		EXPECT_EQ(square, (nines * nines).toString());
+		EXPECT_EQ(square, multiply(nines, nines, 3).toString());
+		EXPECT_EQ(nines * f, multiply(f, nines, 2));
+	}
+}
+
+TEST(CAL_FP01, FactorialTableTest) {
+	static_assert(factorial64(0) == 1, "0! = 1");
+	static_assert(factorial64(MAX_FACTORIAL_64) == 2432902008176640000ULL, "20!");
+	static_assert(factorial128(MAX_FACTORIAL_128) / factorial128(MAX_FACTORIAL_128 - 1) == MAX_FACTORIAL_128, "34! / 33!");
+
+	for (int n = 0; n <= 12; n++)
+		EXPECT_EQ((uint64_t) factorialDinam(n), factorial64(n));
+	for (int n = 0; n <= MAX_FACTORIAL_64; n++)
+		EXPECT_EQ(factorialBig(n), BigInt(factorial64(n)));
+	for (int n = 0; n <= MAX_FACTORIAL_128; n++) {
+		string digits;
+		for (unsigned __int128 value = factorial128(n); value > 0; value /= 10)
+			digits.insert(digits.begin(), (char) ('0' + (int) (value % 10)));
+		EXPECT_EQ(factorialBig(n).toString(), digits);
+	}
+	EXPECT_EQ(factorialBig(MAX_FACTORIAL_128).mod(1000000007), (uint32_t) (factorial128(MAX_FACTORIAL_128) % 1000000007));
+}
+
+TEST(CAL_FP01, FactorialModTest) {
+	auto naive = [](uint32_t n, uint32_t p) {
+		uint64_t res = 1 % p;
+		for (uint64_t i = 2; i <= n; i++)
+			res = res * i % p;
+		return (uint32_t) res;
+	};
+
+	EXPECT_EQ(1u, factorialMod(0, 7));
+	EXPECT_EQ(6u, factorialMod(3, 7));
+	EXPECT_EQ(0u, factorialMod(7, 7));
+	EXPECT_EQ(0u, factorialMod(1000000000, 1000));
+
+	// Wilson's theorem
+	EXPECT_EQ(1000000006u, factorialMod(1000000006, 1000000007));
+	EXPECT_EQ(998244352u, factorialMod(998244352, 998244353));
+
+	for (uint32_t p : {1000000007u, 998244353u, 65537u, 4294967291u})
+		for (uint32_t n : {4097u, 5000u, 65535u, 1000000u})
+			if (n < p) {
+				EXPECT_EQ(naive(n, p), factorialMod(n, p)) << n << "! mod " << p;
+			}
+
+	EXPECT_EQ(927880474u, factorialMod(100000000, 1000000007));
+	EXPECT_EQ(naive(1000001, 1000000007), factorialMod(1000001, 1000000007));
+	EXPECT_EQ(factorialMod(999999999, 1000000007), (uint32_t) ((uint64_t) factorialMod(999999998, 1000000007) * 999999999 % 1000000007));
+}
+
 TEST(CAL_FP01, CalcChangeTest) {
 	int numCoins = 3;
 	int coinValues[] = {1, 2, 5};
@@ -39,6 +119,196 @@ TEST(CAL_FP01, CalcChangeTest) {
 }
 
 
+TEST(CAL_FP01, CalcChangeOverloadsTest) {
+	int coinValues[] = {1, 2, 5};
+
+	string res = "previous content";
+	calcChange(16, 3, coinValues, res);
+	EXPECT_EQ("5;5;5;1;", res);
+	calcChange(0, 3, coinValues, res);
+	EXPECT_EQ("", res);
+
+	char buffer[8];
+	EXPECT_EQ(8u, calcChange(16, 3, coinValues, buffer, sizeof(buffer)));
+	EXPECT_EQ("5;5;5;1;", string(buffer, 8));
+	EXPECT_EQ(10u, calcChange(22, 3, coinValues, buffer, sizeof(buffer))); // does not fit
+
+	vector<int> counts;
+	EXPECT_TRUE(calcChange(16, 3, coinValues, counts));
+	EXPECT_THAT(counts, testing::ElementsAre(1, 0, 3));
+
+	int coinValues2[] = {2, 5};
+	EXPECT_FALSE(calcChange(1, 2, coinValues2, counts));
+	calcChange(1, 2, coinValues2, res);
+	EXPECT_EQ("-", res);
+	EXPECT_EQ(1u, calcChange(1, 2, coinValues2, buffer, sizeof(buffer)));
+	EXPECT_EQ('-', buffer[0]);
+}
+
+
+TEST(CAL_FP01, ChangeTableTest) {
+	int coinValues[] = {1, 4, 5};
+	ChangeTable table(3, coinValues, 10);
+
+	EXPECT_EQ(10, table.getMaxAmount());
+	EXPECT_EQ("4;4;", table.calcChange(8));
+	EXPECT_EQ("", table.calcChange(0));
+	EXPECT_EQ(2, table.getMinCoins(8));
+
+	for (int m = 0; m <= 100; m++)
+		EXPECT_EQ(calcChange(m, 3, coinValues), table.calcChange(m));
+	EXPECT_EQ(21, table.getMaxAmount()); // (5 - 1) * 4 + 5, after that the table is periodic
+
+	int coinValues2[] = {2, 5};
+	ChangeTable table2(2, coinValues2);
+	EXPECT_EQ("-", table2.calcChange(3));
+	EXPECT_EQ(-1, table2.getMinCoins(3));
+	EXPECT_EQ("2;2;2;2;", table2.calcChange(8));
+
+	// far more than what fits in the stack
+	int coinValues3[] = {1, 2, 5, 10, 20, 50, 100, 200};
+	EXPECT_EQ("200;200;200;200;", calcChange(800, 8, coinValues3));
+	EXPECT_EQ(25009, ChangeTable(8, coinValues3).getMinCoins(5000599));
+}
+
+
+TEST(CAL_FP01, CanonicalChangeTest) {
+	int euro[] = {1, 2, 5, 10, 20, 50, 100, 200};
+	int coinValues[] = {1, 3, 4};
+	int coinValues2[] = {2, 5};
+	int coinValues3[] = {1, 2, 3};
+
+	EXPECT_TRUE(isCanonical(8, euro));
+	EXPECT_FALSE(isCanonical(3, coinValues)); // 6 = 3 + 3
+	EXPECT_FALSE(isCanonical(2, coinValues2));
+	EXPECT_TRUE(isCanonical(3, coinValues3));
+
+	EXPECT_EQ("3;3;", calcChange(6, 3, coinValues));
+	EXPECT_EQ("3;1;", calcChange(4, 3, coinValues3));
+
+	// greedy needs no table, so even huge amounts are immediate
+	vector<int> counts;
+	EXPECT_TRUE(calcChange(1000000007, 8, euro, counts));
+	EXPECT_THAT(counts, testing::ElementsAre(0, 1, 1, 0, 0, 0, 0, 5000000));
+
+	ChangeTable table(8, euro, 1000);
+	EXPECT_TRUE(table.isCanonical());
+	EXPECT_EQ(0, table.getMaxAmount());
+	EXPECT_EQ("200;50;20;5;2;1;", table.calcChange(278));
+	EXPECT_EQ(5000002, table.getMinCoins(1000000007));
+}
+
+
+TEST(CAL_FP01, PeriodicChangeTest) {
+	int coinValues[] = {1, 4, 5};
+	ChangeTable table(3, coinValues);
+
+	// 10^12 = 199999999996 * 5 + 4 + 4 + 4 + 4 + 4
+	vector<long long> counts;
+	EXPECT_TRUE(table.calcChange(1000000000020LL, counts));
+	EXPECT_THAT(counts, testing::ElementsAre(0, 0, 200000000004LL));
+	EXPECT_TRUE(calcChange(1000000000003LL, 3, coinValues, counts));
+	EXPECT_THAT(counts, testing::ElementsAre(0, 2, 199999999999LL));
+	EXPECT_EQ(200000000001LL, table.getMinCoins(1000000000003LL));
+	EXPECT_LE(table.getMaxAmount(), 21);
+
+	int coinValues2[] = {4, 6, 10};
+	EXPECT_FALSE(calcChange(1000000000007LL, 3, coinValues2, counts)); // only even amounts
+	EXPECT_TRUE(calcChange(1000000000002LL, 3, coinValues2, counts));
+	EXPECT_THAT(counts, testing::ElementsAre(0, 2, 99999999999LL));
+
+	// the periodicity bound (c - 1) * c' + c = 1599960000 doesn't fit in the table:
+	// amounts in the table are still exact, the ones above it are refused
+	int coinValues3[] = {1, 39999, 40000};
+	ChangeTable table3(3, coinValues3);
+	EXPECT_FALSE(table3.isCanonical());
+	EXPECT_TRUE(table3.isSupported(79998));
+	EXPECT_EQ(2, table3.getMinCoins(79998));
+	EXPECT_EQ("39999;39999;", table3.calcChange(79998));
+	EXPECT_EQ("39999;39999;", calcChange(79998, 3, coinValues3));
+	EXPECT_FALSE(table3.isSupported(2000000000000LL));
+	EXPECT_EQ(-1, table3.getMinCoins(2000000000000LL));
+	EXPECT_FALSE(table3.calcChange(2000000000000LL, counts));
+	EXPECT_FALSE(calcChange(2000000000000LL, 3, coinValues3, counts));
+
+	// canonical systems don't need the table, whatever their coins
+	int coinValues4[] = {1, 1 << 20, 1 << 21};
+	ChangeTable table4(3, coinValues4);
+	EXPECT_TRUE(table4.isSupported(2000000000000LL));
+	EXPECT_EQ(1000000 + 1, table4.getMinCoins((1LL << 21) * 1000000 + 1));
+}
+
+
+TEST(CAL_FP01, BoundedChangeTest) {
+	int coinValues[] = {1, 2, 5};
+	int limits[] = {5, 5, 1};
+	int noOnes[] = {0, 1, 1};
+
+	EXPECT_EQ("5;2;2;2;1;", calcChange(12, 3, coinValues, limits));
+	EXPECT_EQ("-", calcChange(4, 3, coinValues, noOnes));
+	EXPECT_EQ("", calcChange(0, 3, coinValues, noOnes));
+
+	vector<int> counts;
+	EXPECT_TRUE(calcChange(12, 3, coinValues, limits, counts));
+	EXPECT_THAT(counts, testing::ElementsAre(1, 3, 1));
+	EXPECT_FALSE(calcChange(21, 3, coinValues, limits, counts));
+
+	// against the same problem with each coin repeated as many times as its limit
+	srand(8);
+	for (int test = 0; test < 50; test++) {
+		int values[] = {1 + rand() % 3, 4 + rand() % 3, 7 + rand() % 5};
+		int maxCounts[] = {rand() % 4, rand() % 4, rand() % 4};
+		int m = rand() % 40;
+
+		vector<int> minCoins(m + 1, -1);
+		minCoins[0] = 0;
+		for (int i = 0; i < 3; i++)
+			for (int copy = 0; copy < maxCounts[i]; copy++)
+				for (int j = m; j >= values[i]; j--)
+					if (minCoins[j - values[i]] >= 0 && (minCoins[j] < 0 || minCoins[j - values[i]] + 1 < minCoins[j]))
+						minCoins[j] = minCoins[j - values[i]] + 1;
+
+		bool possible = calcChange(m, 3, values, maxCounts, counts);
+		ASSERT_EQ(minCoins[m] >= 0, possible);
+		if (possible) {
+			EXPECT_EQ(minCoins[m], counts[0] + counts[1] + counts[2]);
+			EXPECT_EQ(m, counts[0] * values[0] + counts[1] * values[1] + counts[2] * values[2]);
+			for (int i = 0; i < 3; i++)
+				EXPECT_LE(counts[i], maxCounts[i]);
+		}
+	}
+}
+
+
+TEST(CAL_FP01, CountChangeTest) {
+	int coins[] = {1, 2, 5};
+	EXPECT_EQ("4", countChange(5, 3, coins).toString());
+	EXPECT_EQ("1", countChange(0, 3, coins).toString());
+	EXPECT_EQ(4u, countChange(5, 3, coins, 1000000007));
+
+	int cents[] = {1, 5, 10, 25, 50, 100};
+	EXPECT_EQ("292", countChange(100, 5, cents).toString());
+	EXPECT_EQ("293", countChange(100, 6, cents).toString());
+	EXPECT_EQ(292u, countChange(100, 5, cents, 1000000007));
+
+	int odd[] = {2, 4};
+	EXPECT_EQ("0", countChange(7, 2, odd).toString());
+	EXPECT_EQ(0u, countChange(1000000000001LL, 2, odd, 998244353));
+
+	// big enough to go through the polynomial method, against the exact count
+	BigInt exact = countChange(300000, 5, cents);
+	EXPECT_EQ(exact.mod(1000000007), countChange(300000, 5, cents, 1000000007));
+	EXPECT_EQ(exact.mod(4294967291u), countChange(300000, 5, cents, 4294967291u, 3));
+
+	// with {1, 2, 3} there are round((m + 3)^2 / 12) ways
+	int small[] = {1, 2, 3};
+	for (long long m : {1000000LL, 123456789012LL, 1000000000000000000LL}) {
+		unsigned __int128 ways = ((unsigned __int128) (m + 3) * (m + 3) + 6) / 12;
+		EXPECT_EQ((uint32_t) (ways % 1000000007), countChange(m, 3, small, 1000000007)) << m;
+		EXPECT_EQ((uint32_t) (ways % 1000000007), countChange(m, 3, small, 1000000007, 2)) << m;
+	}
+}
+
 TEST(CAL_FP01, CalcSumArrayTest) {
 	int sequence[5] = {4,7,2,8,1};
 	int sequence2[9] = {6,1,10,3,2,6,7,2,4};
@@ -47,8 +317,289 @@ TEST(CAL_FP01, CalcSumArrayTest) {
 	EXPECT_EQ("1,1;5,3;11,3;16,1;20,3;24,3;31,1;35,1;41,0;",calcSum(sequence2, 9));
 }
 
-TEST(CAL_FP01, Benchmark) {
-	//benchmark();
+TEST(CAL_FP01, CalcSumOverloadsTest) {
+	int sequence[5] = {-4,7,2,8,-1};
+	string expected = calcSum(sequence, 5);
+
+	string res;
+	calcSum(sequence, 5, res);
+	EXPECT_EQ(expected, res);
+
+	char buffer[64];
+	size_t length = calcSum(sequence, 5, buffer, sizeof(buffer));
+	EXPECT_EQ(expected, string(buffer, length));
+	EXPECT_EQ(expected.size(), calcSum(sequence, 5, buffer, 3));
+
+	vector<pair<int, int>> pairs;
+	calcSum(sequence, 5, pairs);
+	EXPECT_THAT(pairs, testing::ElementsAre(make_pair(-4, 0), make_pair(3, 0), make_pair(5, 0), make_pair(13, 0), make_pair(12, 0)));
+}
+
+TEST(CAL_FP01, CalcSumPrefixTest) {
+	int sequence[5] = {4,7,2,8,1};
+	int sequence2[9] = {6,1,10,3,2,6,7,2,4};
+
+	SumKernel kernels[] = {SUM_KERNEL_SCALAR, SUM_KERNEL_SSE, SUM_KERNEL_AVX2, SUM_KERNEL_AUTO};
+	for (SumKernel kernel : kernels) {
+		if (!isSumKernelSupported(kernel))
+			continue;
+		setSumKernel(kernel);
+
+		EXPECT_EQ("1,4;9,1;11,2;18,1;22,0;",calcSumPrefix(sequence, 5));
+		EXPECT_EQ("1,1;5,3;11,3;16,1;20,3;24,3;31,1;35,1;41,0;",calcSumPrefix(sequence2, 9));
+
+		srand(kernel);
+		int random[157];
+		for (int &v : random)
+			v = rand() % 21 - 10;
+		EXPECT_EQ(calcSum(random, 157), calcSumPrefix(random, 157));
+	}
+	setSumKernel(SUM_KERNEL_AUTO);
+}
+
+TEST(CAL_FP01, CalcSumParallelTest) {
+	int sequence[5] = {4,7,2,8,1};
+	EXPECT_EQ("1,4;9,1;11,2;18,1;22,0;",calcSumParallel(sequence, 5, 8));
+
+	int random[301];
+	srand(301);
+	for (int &v : random)
+		v = rand() % 1000 - 500;
+
+	string expected = calcSum(random, 301);
+	for (int numThreads = 1; numThreads <= 8; numThreads *= 2)
+		EXPECT_EQ(expected, calcSumParallel(random, 301, numThreads));
+}
+
+/*
+ * For every m, the first index of the minimum sum of m consecutive values, summing them one by one.
+ */
+template <typename T, typename Acc>
+static vector<pair<Acc, int>> bruteForceMinSums(const vector<T> &sequence) {
+	int size = sequence.size();
+	vector<pair<Acc, int>> res;
+	for (int m = 1; m <= size; m++) {
+		pair<Acc, int> best(0, -1);
+		for (int i = 0; i + m <= size; i++) {
+			Acc sum = 0;
+			for (int j = i; j < i + m; j++)
+				sum += sequence[j];
+			if (best.second < 0 || sum < best.first)
+				best = make_pair(sum, i);
+		}
+		res.push_back(best);
+	}
+	return res;
+}
+
+template <typename T, typename Acc>
+static void expectGenericMinSums(const vector<T> &sequence) {
+	for (SumKernel kernel : {SUM_KERNEL_SCALAR, SUM_KERNEL_AUTO}) {
+		setSumKernel(kernel);
+		vector<pair<Acc, int>> result;
+		calcSum(sequence.data(), (int) sequence.size(), result);
+		EXPECT_EQ((bruteForceMinSums<T, Acc>(sequence)), result);
+	}
+	setSumKernel(SUM_KERNEL_AUTO);
+}
+
+TEST(CAL_FP01, CalcSumGenericTest) {
+	srand(17);
+
+	// small values: every window fits in 16 bits
+	vector<int16_t> small(300);
+	for (int16_t &v : small)
+		v = (int16_t) (rand() % 11 - 5);
+	expectGenericMinSums<int16_t, int32_t>(small);
+
+	// big ones go through 16, 32 and 64 bit windows
+	vector<int16_t> wide(200);
+	for (int16_t &v : wide)
+		v = (int16_t) (rand() % 60001 - 30000);
+	expectGenericMinSums<int16_t, int64_t>(wide);
+
+	vector<int32_t> ints(150);
+	for (int32_t &v : ints)
+		v = rand() % 2000 - 1000;
+	expectGenericMinSums<int32_t, int32_t>(ints);
+
+	// the same as the int version
+	vector<pair<int, int>> expected;
+	calcSum(ints.data(), (int) ints.size(), expected);
+	vector<pair<int64_t, int>> result;
+	calcSum((const int32_t *) ints.data(), (int) ints.size(), result);
+	for (size_t m = 0; m < ints.size(); m++)
+		EXPECT_EQ(expected[m], make_pair((int) result[m].first, result[m].second));
+
+	// sums past INT_MAX, that overflow the int version
+	vector<int32_t> huge(64);
+	for (int32_t &v : huge)
+		v = INT32_MAX - rand() % 1000;
+	expectGenericMinSums<int32_t, int64_t>(huge);
+	calcSum((const int32_t *) huge.data(), (int) huge.size(), result);
+	int64_t total = 0;
+	for (int32_t v : huge)
+		total += v;
+	EXPECT_EQ(make_pair(total, 0), result[63]);
+
+	vector<int64_t> longs(100);
+	for (int64_t &v : longs)
+		v = (int64_t) (rand() % 2001 - 1000) * 1000000000000LL;
+	expectGenericMinSums<int64_t, int64_t>(longs);
+
+	// integer valued reals, so that every sum is exact
+	vector<float> floats(257);
+	for (float &v : floats)
+		v = (float) (rand() % 2001 - 1000);
+	expectGenericMinSums<float, float>(floats);
+	expectGenericMinSums<float, double>(floats);
+
+	vector<double> doubles(130);
+	for (double &v : doubles)
+		v = (rand() % 2001 - 1000) * 0.5;
+	expectGenericMinSums<double, double>(doubles);
+}
+
+/*
+ * Every k x k window summed value by value, keeping the first minimum in row-major order.
+ */
+static vector<MinWindow2D> bruteForceMinWindows2D(const vector<int> &matrix, int rows, int cols) {
+	vector<MinWindow2D> res;
+	for (int k = 1; k <= min(rows, cols); k++) {
+		MinWindow2D best = {0, -1, -1};
+		for (int r = 0; r + k <= rows; r++)
+			for (int c = 0; c + k <= cols; c++) {
+				long long sum = 0;
+				for (int i = r; i < r + k; i++)
+					for (int j = c; j < c + k; j++)
+						sum += matrix[i * cols + j];
+				if (best.row < 0 || sum < best.sum)
+					best = {sum, r, c};
+			}
+		res.push_back(best);
+	}
+	return res;
+}
+
+static void expectMinWindows2D(const vector<int> &matrix, int rows, int cols) {
+	vector<MinWindow2D> expected = bruteForceMinWindows2D(matrix, rows, cols);
+
+	for (SumKernel kernel : {SUM_KERNEL_SCALAR, SUM_KERNEL_AUTO})
+		for (int numThreads : {1, 3}) {
+			setSumKernel(kernel);
+			vector<MinWindow2D> result;
+			calcSum2D(matrix.data(), rows, cols, result, numThreads);
+
+			ASSERT_EQ(expected.size(), result.size());
+			for (size_t k = 0; k < expected.size(); k++) {
+				EXPECT_EQ(expected[k].sum, result[k].sum) << "k = " << k + 1;
+				EXPECT_EQ(expected[k].row, result[k].row) << "k = " << k + 1;
+				EXPECT_EQ(expected[k].col, result[k].col) << "k = " << k + 1;
+			}
+		}
+	setSumKernel(SUM_KERNEL_AUTO);
+}
+
+TEST(CAL_FP01, CalcSum2DTest) {
+	// 1 2 3
+	// 4 0 6
+	vector<int> small = {1, 2, 3, 4, 0, 6};
+	vector<MinWindow2D> result;
+	calcSum2D(small.data(), 2, 3, result);
+	ASSERT_EQ(2u, result.size());
+	EXPECT_EQ(0, result[0].sum);
+	EXPECT_EQ(1, result[0].row);
+	EXPECT_EQ(1, result[0].col);
+	EXPECT_EQ(7, result[1].sum);
+	EXPECT_EQ(0, result[1].col);
+
+	calcSum2D(small.data(), 0, 3, result);
+	EXPECT_TRUE(result.empty());
+
+	srand(23);
+	int rows = 37, cols = 53;
+	vector<int> matrix(rows * cols);
+	for (int &v : matrix)
+		v = rand() % 21 - 10; // lots of ties
+	expectMinWindows2D(matrix, rows, cols);
+
+	// sums past INT_MAX go through the 64 bit table
+	for (int &v : matrix)
+		v = (rand() % 2 == 0 ? -1 : 1) * (INT32_MAX - rand() % 1000);
+	expectMinWindows2D(matrix, rows, cols);
+
+	// wider than a tile of columns
+	rows = 4;
+	cols = 2100;
+	matrix.resize(rows * cols);
+	for (int &v : matrix)
+		v = rand() % 1001 - 500;
+	expectMinWindows2D(matrix, rows, cols);
+}
+
+TEST(CAL_FP01, CalcSumStreamTest) {
+	int sequence2[9] = {6,1,10,3,2,6,7,2,4};
+	long long sequence64[9] = {6,1,10,3,2,6,7,2,4};
+	string expected = "1,1;5,3;11,3;16,1;20,3;24,3;31,1;35,1;41,0;";
+
+	stringstream in32(string((char *) sequence2, sizeof(sequence2)));
+	EXPECT_EQ(expected, calcSumStream(in32, SUM_INT32));
+
+	stringstream in64(string((char *) sequence64, sizeof(sequence64)));
+	EXPECT_EQ(expected, calcSumStream(in64, SUM_INT64));
+
+	stringstream truncated(string((char *) sequence2, sizeof(sequence2) - 1));
+	EXPECT_EQ("-", calcSumStream(truncated, SUM_INT32));
+
+	ofstream file("sum_stream.bin", ios::binary);
+	file.write((char *) sequence64, sizeof(sequence64));
+	file.close();
+	EXPECT_EQ(expected, calcSumFile("sum_stream.bin", SUM_INT64));
+	remove("sum_stream.bin");
+
+	EXPECT_EQ("-", calcSumFile("does_not_exist.bin", SUM_INT32));
+}
+
+TEST(CAL_FP01, BenchmarkStatisticsTest) {
+	vector<long long> samples;
+	for (int i = 100; i >= 1; i--)
+		samples.push_back(i * 1000);
+
+	BenchmarkResult r = summarize("test", 500, samples);
+	EXPECT_EQ(100, r.measurements);
+	EXPECT_DOUBLE_EQ(1000, r.min);
+	EXPECT_DOUBLE_EQ(50500, r.mean);
+	EXPECT_DOUBLE_EQ(50500, r.median);
+	EXPECT_DOUBLE_EQ(95000, r.p95);
+	EXPECT_DOUBLE_EQ(99000, r.p99);
+	EXPECT_DOUBLE_EQ(500 * 1e9 / 50500, r.throughput);
+
+	int calls = 0;
+	BenchmarkResult m = measure("count", 1, [&]() { calls++; }, 2, 5);
+	EXPECT_EQ(7, calls);
+	EXPECT_EQ(5, m.measurements);
+	EXPECT_LE(m.min, m.median);
+	EXPECT_LE(m.median, m.p99);
+	EXPECT_EQ(-1, m.allocations);
+
+	// allocations per call, from a counter the caller keeps
+	static long long counted;
+	counted = 0;
+	setAllocationCounter([]() { return counted; });
+	BenchmarkResult a = measure("allocating", 1, [&]() { counted += 3; }, 1, 4);
+	setAllocationCounter(nullptr);
+	EXPECT_DOUBLE_EQ(3, a.allocations);
+
+	// "fast" wins from size 4 on; at size 2 it loses, at size 1 it won by chance
+	BenchmarkReport report;
+	double slow[] = {10, 20, 40, 80, 160}, fast[] = {5, 30, 30, 30, 30};
+	for (int i = 0; i < 5; i++) {
+		report.add(summarize("slow", 1LL << i, {(long long) slow[i]}));
+		report.add(summarize("fast", 1LL << i, {(long long) fast[i]}));
+	}
+	EXPECT_EQ(4, report.crossover("slow", "fast"));
+	EXPECT_EQ(-1, report.crossover("fast", "slow"));
+	EXPECT_EQ(-1, report.crossover("slow", "missing"));
 }
 
 
@@ -65,3 +616,146 @@ TEST(CAL_FP01, PartitioningTest) {
 	EXPECT_EQ(1382958545,b_dynamic(15));
 }
 
+
+TEST(CAL_FP01, PartitionTableTest) {
+	PartitionTable<uint64_t> &table = PartitionTable<uint64_t>::shared();
+	EXPECT_EQ(&table, &PartitionTable<uint64_t>::shared());
+
+	uint64_t value;
+	EXPECT_TRUE(table.getStirling(10, 6, value));
+	EXPECT_EQ(22827u, value);
+	EXPECT_EQ(11, table.getNumRows());
+	EXPECT_TRUE(table.getStirling(3, 5, value));
+	EXPECT_EQ(0u, value);
+	EXPECT_TRUE(table.getStirling(0, 0, value));
+	EXPECT_EQ(1u, value);
+	EXPECT_FALSE(table.getStirling(-1, 0, value));
+
+	for (int n = 1; n <= 12; n++) {
+		EXPECT_TRUE(table.getBell(n, value));
+		EXPECT_EQ((uint64_t) b_recursive(n), value);
+		for (int k = 1; k <= n; k++) {
+			EXPECT_TRUE(table.getStirling(n, k, value));
+			EXPECT_EQ((uint64_t) s_dynamic(n, k), value);
+		}
+	}
+
+	// B(25) is the last Bell number below 2^64
+	EXPECT_TRUE(table.getBell(25, value));
+	EXPECT_EQ(4638590332229999353ULL, value);
+	EXPECT_FALSE(table.getBell(26, value));
+	EXPECT_FALSE(table.getStirling(40, 3, value));
+	EXPECT_EQ(26, table.getNumRows());
+
+	// the wider tables agree and go further
+	PartitionTable<unsigned __int128> wide;
+	PartitionTable<BigInt> big;
+	unsigned __int128 wideValue;
+	BigInt bigValue;
+	EXPECT_TRUE(wide.getBell(30, wideValue));
+	EXPECT_TRUE(big.getBell(30, bigValue));
+	EXPECT_EQ("846749014511809332450147", bigValue.toString());
+	EXPECT_EQ(bigValue.mod(1000000007), (uint32_t) (wideValue % 1000000007));
+	EXPECT_TRUE(wide.getBell(42, wideValue));
+	EXPECT_FALSE(wide.getBell(43, wideValue));
+	EXPECT_TRUE(big.getStirling(100, 50, bigValue));
+	EXPECT_EQ(102u, bigValue.numDigits());
+
+	// concurrent queries all see the same rows
+	vector<thread> threads;
+	vector<int> ok(4, 1);
+	for (int t = 0; t < 4; t++)
+		threads.emplace_back([&, t]() {
+			PartitionTable<BigInt> &shared = PartitionTable<BigInt>::shared();
+			for (int n = 60 - t; n >= 0; n -= 3) {
+				BigInt a, b;
+				ok[t] = ok[t] && shared.getBell(n, a) && big.getBell(n, b) && a == b;
+			}
+		});
+	for (thread &t : threads)
+		t.join();
+	EXPECT_EQ(vector<int>(4, 1), ok);
+}
+
+TEST(CAL_FP01, BellNumbersTest) {
+	vector<uint64_t> bell;
+	EXPECT_TRUE(bellNumbers(0, bell));
+	EXPECT_EQ(vector<uint64_t>({1}), bell);
+	EXPECT_TRUE(bellNumbers(6, bell));
+	EXPECT_EQ(vector<uint64_t>({1, 1, 2, 5, 15, 52, 203}), bell);
+	EXPECT_TRUE(bellNumbers(25, bell));
+	EXPECT_EQ(4638590332229999353ULL, bell[25]);
+	EXPECT_FALSE(bellNumbers(26, bell));
+
+	vector<unsigned __int128> wide;
+	EXPECT_TRUE(bellNumbers(42, wide));
+	EXPECT_FALSE(bellNumbers(43, wide));
+
+	vector<BigInt> big;
+	bellNumbers(100, big);
+	ASSERT_EQ(101u, big.size());
+	BigInt value;
+	for (int n = 0; n <= 100; n += 7) {
+		EXPECT_TRUE(PartitionTable<BigInt>::shared().getBell(n, value));
+		EXPECT_EQ(value, big[n]);
+	}
+	EXPECT_EQ(big[42].mod(1000000007), (uint32_t) (wide[42] % 1000000007));
+
+	vector<uint32_t> mod;
+	bellNumbersMod(100, 1000000007, mod);
+	for (int n = 0; n <= 100; n++)
+		EXPECT_EQ(big[n].mod(1000000007), mod[n]);
+
+	// Touchard's congruence, for n beyond the batch
+	for (uint32_t p : {2u, 7u, 13u, 101u})
+		for (int n = 0; n <= 100; n += 3)
+			EXPECT_EQ(big[n].mod(p), bellMod(n, p)) << "B(" << n << ") mod " << p;
+
+	// B(m + p) = B(m) + B(m + 1) mod p, stepped one m at a time up to 10^5
+	uint32_t p = 13;
+	bellNumbersMod(p, p, mod);
+	for (int m = p + 1; m <= 100000; m++)
+		mod.push_back((mod[m - p] + mod[m - p + 1]) % p);
+	for (int n : {1000, 54321, 100000})
+		EXPECT_EQ(mod[n], bellMod(n, p));
+
+	// and huge n stay consistent with it
+	unsigned long long huge = 1000000000000000000ULL;
+	EXPECT_EQ(bellMod(huge + 1009, 1009), (bellMod(huge, 1009) + bellMod(huge + 1, 1009)) % 1009);
+}
+
+TEST(CAL_FP01, StirlingRowTest) {
+	vector<uint32_t> row;
+	stirlingRowMod(0, row);
+	EXPECT_EQ(vector<uint32_t>({1}), row);
+	stirlingRowMod(4, row);
+	EXPECT_EQ(vector<uint32_t>({0, 1, 7, 6, 1}), row);
+
+	BigInt value;
+	stirlingRowMod(150, row);
+	for (int k = 0; k <= 150; k++) {
+		EXPECT_TRUE(PartitionTable<BigInt>::shared().getStirling(150, k, value));
+		EXPECT_EQ(value.mod(STIRLING_MOD), row[k]) << "S(150, " << k << ")";
+	}
+
+	// S(n, 1) = S(n, n) = 1, S(n, 2) = 2^(n-1) - 1, S(n, n-1) = n (n-1) / 2
+	int n = 300000;
+	stirlingRowMod(n, row);
+	ASSERT_EQ((size_t) n + 1, row.size());
+	EXPECT_EQ(0u, row[0]);
+	EXPECT_EQ(1u, row[1]);
+	EXPECT_EQ(1u, row[n]);
+	EXPECT_EQ((powMod<NTT_MOD_A>(2, n - 1) + STIRLING_MOD - 1) % STIRLING_MOD, row[2]);
+	EXPECT_EQ((uint32_t) ((long long) n * (n - 1) / 2 % STIRLING_MOD), row[n - 1]);
+
+	// the vectorized transform against the definition
+	vector<uint32_t> a(300), b(177), c(a.size() + b.size() - 1, 0);
+	for (size_t i = 0; i < a.size(); i++)
+		a[i] = (uint32_t) (i * 2654435761u % NTT_MOD_A);
+	for (size_t i = 0; i < b.size(); i++)
+		b[i] = (uint32_t) (i * 40503u % NTT_MOD_A);
+	for (size_t i = 0; i < a.size(); i++)
+		for (size_t j = 0; j < b.size(); j++)
+			c[i + j] = (uint32_t) ((c[i + j] + (uint64_t) a[i] * b[j]) % NTT_MOD_A);
+	EXPECT_EQ(c, convolution<NTT_MOD_A>(a, b));
+}
@@ -0,0 +1,42 @@
+/*
+ * batch.cpp
+ *
+ * Solves a file of puzzles, one 81 character line each ('0' or '.' for empty cells), writing the solutions in the
+ * same order and reporting the throughput and the per puzzle latency percentiles.
+ * Usage: CAL_FP02_batch <puzzles> [solutions|-] [threads] [backtracking|dlx]
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+#include "src/SudokuBatch.h"
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+	if (argc < 2) {
+		cerr << "Usage: " << argv[0] << " <puzzles> [solutions|-] [threads] [backtracking|dlx]" << endl;
+		return 1;
+	}
+
+	string inPath = argv[1];
+	string outPath = argc > 2 ? argv[2] : "-";
+	int numThreads = argc > 3 ? atoi(argv[3]) : (int) thread::hardware_concurrency();
+	SudokuBackend backend = argc > 4 && string(argv[4]) == "dlx" ? DANCING_LINKS : BACKTRACKING;
+
+	BatchResult result;
+	if (!solveBatchFile(inPath, outPath, numThreads, backend, result)) {
+		cerr << "Could not solve " << inPath << " into " << outPath << endl;
+		return 1;
+	}
+
+	// the statistics stay out of the way when the solutions go to the standard output
+	ostream &stats = outPath == "-" ? cerr : cout;
+	stats << result.solved << "/" << result.puzzles << " puzzles solved in " << result.seconds << " s ("
+		  << result.puzzlesPerSecond << " puzzles/s)" << endl;
+	stats << "latency (us): p50 " << result.latencyP50 << ", p90 " << result.latencyP90 << ", p99 "
+		  << result.latencyP99 << ", max " << result.latencyMax << endl;
+
+	return 0;
+}
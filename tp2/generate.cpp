@@ -0,0 +1,66 @@
+/*
+ * generate.cpp
+ *
+ * Generates puzzles with a single solution and as few clues as possible, one 81 character line each ('0' for
+ * empty cells), so they can be fed back to CAL_FP02_batch.
+ * Usage: CAL_FP02_generator [puzzles] [target clues] [seconds per puzzle] [threads] [seed] [output|-]
+ */
+
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+#include "src/SudokuGenerator.h"
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+	int numPuzzles = argc > 1 ? atoi(argv[1]) : 10;
+	int targetClues = argc > 2 ? atoi(argv[2]) : 22;
+	double seconds = argc > 3 ? atof(argv[3]) : 1;
+	int numThreads = argc > 4 ? atoi(argv[4]) : (int) thread::hardware_concurrency();
+	unsigned seed = argc > 5 ? (unsigned) strtoul(argv[5], nullptr, 10) : (unsigned) time(nullptr);
+	string outPath = argc > 6 ? argv[6] : "-";
+
+	FILE *out = outPath == "-" ? stdout : fopen(outPath.c_str(), "w");
+	if (out == nullptr) {
+		cerr << "Could not open " << outPath << endl;
+		return 1;
+	}
+
+	auto begin = chrono::steady_clock::now();
+	vector<GeneratedPuzzle> puzzles;
+	generatePuzzles(numPuzzles, seed, targetClues, seconds, numThreads, puzzles);
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+	long long totalClues = 0;
+	int fewestClues = 81, reached = 0;
+
+	for (const GeneratedPuzzle &puzzle : puzzles) {
+		char line[83];
+		for (int k = 0; k < 81; k++)
+			line[k] = (char) ('0' + puzzle.numbers[k / 9][k % 9]);
+		line[81] = '\n';
+		line[82] = '\0';
+		fputs(line, out);
+
+		totalClues += puzzle.clues;
+		fewestClues = min(fewestClues, puzzle.clues);
+		reached += puzzle.clues <= targetClues;
+	}
+
+	if (out != stdout)
+		fclose(out);
+
+	// the statistics stay out of the way when the puzzles go to the standard output
+	ostream &stats = outPath == "-" ? cerr : cout;
+	stats << puzzles.size() << " puzzles in " << elapsed << " s, " << reached << " with at most " << targetClues
+		  << " clues" << endl;
+	if (!puzzles.empty())
+		stats << "clues: average " << (double) totalClues / puzzles.size() << ", fewest " << fewestClues << endl;
+
+	return 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * DancingLinks.cpp
+ */
+
+#include "DancingLinks.h"
+
+// node 0 is the root, nodes 1..COLUMNS the column headers and the row of
+// (i, j, n) owns the 4 nodes starting at firstNode(i, j, n)
+static int firstNode(int i, int j, int n) {
+	return 1 + DancingLinks::COLUMNS + 4 * ((i * 9 + j) * 9 + n - 1);
+}
+
+static int numberOfRow(int node) {
+	return (node - 1 - DancingLinks::COLUMNS) / 4 % 9 + 1;
+}
+
+static int cellOfRow(int node) {
+	return (node - 1 - DancingLinks::COLUMNS) / 4 / 9;
+}
+
+
+DancingLinks::DancingLinks() {
+	for (int c = 0; c <= COLUMNS; c++) {
+		left[c] = c == 0 ? COLUMNS : c - 1;
+		right[c] = c == COLUMNS ? 0 : c + 1;
+		up[c] = down[c] = column[c] = c;
+		size[c] = 0;
+	}
+
+	for (int i = 0; i < 9; i++) {
+		for (int j = 0; j < 9; j++) {
+			for (int n = 1; n <= 9; n++) {
+				int first = firstNode(i, j, n);
+				int columns[4] = {
+						1 + i * 9 + j,
+						1 + 81 + i * 9 + n - 1,
+						1 + 2 * 81 + j * 9 + n - 1,
+						1 + 3 * 81 + (i / 3 * 3 + j / 3) * 9 + n - 1};
+
+				for (int k = 0; k < 4; k++) {
+					int node = first + k;
+					int c = columns[k];
+
+					left[node] = first + (k + 3) % 4;
+					right[node] = first + (k + 1) % 4;
+
+					column[node] = c;
+					up[node] = up[c];
+					down[node] = c;
+					down[up[c]] = node;
+					up[c] = node;
+					size[c]++;
+				}
+			}
+		}
+	}
+}
+
+void DancingLinks::cover(int c) {
+	right[left[c]] = right[c];
+	left[right[c]] = left[c];
+
+	for (int i = down[c]; i != c; i = down[i]) {
+		for (int j = right[i]; j != i; j = right[j]) {
+			down[up[j]] = down[j];
+			up[down[j]] = up[j];
+			size[column[j]]--;
+		}
+	}
+}
+
+void DancingLinks::uncover(int c) {
+	for (int i = up[c]; i != c; i = up[i]) {
+		for (int j = left[i]; j != i; j = left[j]) {
+			size[column[j]]++;
+			down[up[j]] = j;
+			up[down[j]] = j;
+		}
+	}
+
+	right[left[c]] = c;
+	left[right[c]] = c;
+}
+
+void DancingLinks::select(int r) {
+	cover(column[r]);
+	for (int j = right[r]; j != r; j = right[j])
+		cover(column[j]);
+}
+
+void DancingLinks::unselect(int r) {
+	for (int j = left[r]; j != r; j = left[j])
+		uncover(column[j]);
+	uncover(column[r]);
+}
+
+bool DancingLinks::search(int depth, int &solutionSize) {
+	if (right[0] == 0) {
+		solutionSize = depth;
+		return true;
+	}
+
+	// the column with the fewest rows left gives the smallest branching
+	int c = right[0];
+	for (int j = right[c]; j != 0; j = right[j])
+		if (size[j] < size[c])
+			c = j;
+
+	if (size[c] == 0)
+		return false;
+
+	bool found = false;
+	cover(c);
+
+	for (int r = down[c]; r != c && !found; r = down[r]) {
+		solution[depth] = r;
+
+		for (int j = right[r]; j != r; j = right[j])
+			cover(column[j]);
+
+		found = search(depth + 1, solutionSize);
+
+		for (int j = left[r]; j != r; j = left[j])
+			uncover(column[j]);
+	}
+
+	uncover(c);
+	return found;
+}
+
+bool DancingLinks::solve(int numbers[9][9]) {
+	int clues[81];
+	int numClues = 0;
+	bool valid = true;
+
+	for (int i = 0; i < 9 && valid; i++) {
+		for (int j = 0; j < 9 && valid; j++) {
+			if (!numbers[i][j])
+				continue;
+
+			int r = firstNode(i, j, numbers[i][j]);
+
+			// a covered column no longer links back from its old neighbour, which
+			// means an earlier clue already uses that cell, line, column or block
+			for (int k = 0; k < 4 && valid; k++)
+				valid = right[left[column[r + k]]] == column[r + k];
+
+			if (valid) {
+				select(r);
+				clues[numClues++] = r;
+			}
+		}
+	}
+
+	int solutionSize = 0;
+	bool solved = valid && search(0, solutionSize);
+
+	for (int k = numClues - 1; k >= 0; k--)
+		unselect(clues[k]);
+
+	if (solved) {
+		for (int k = 0; k < solutionSize; k++) {
+			int cell = cellOfRow(solution[k]);
+			numbers[cell / 9][cell % 9] = numberOfRow(solution[k]);
+		}
+	}
+
+	return solved;
+}
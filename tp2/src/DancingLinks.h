@@ -0,0 +1,56 @@
+/*
+ * DancingLinks.h
+ *
+ */
+
+#ifndef DANCINGLINKS_H_
+#define DANCINGLINKS_H_
+
+/**
+ * Exact cover solver for 9x9 Sudokus (Knuth's Algorithm X with dancing links).
+ *
+ * Each of the 729 rows places a number in a cell and covers 4 of the 324 columns
+ * (cell filled, number in line, number in column, number in block). The whole
+ * matrix lives in flat arrays built once by the constructor; solve() covers the
+ * clues, searches and then uncovers everything again, so the same instance can
+ * solve any number of puzzles without allocating.
+ */
+class DancingLinks {
+public:
+	static const int COLUMNS = 4 * 81;
+	static const int ROWS = 9 * 81;
+	static const int NODES = 1 + COLUMNS + 4 * ROWS; // root, column headers and row nodes
+
+	DancingLinks();
+
+	/**
+	 * Solves the Sudoku in place.
+	 *
+	 * @param numbers the grid, 0 meaning empty; only changed on success
+	 * @return false if the clues clash or the Sudoku is impossible
+	 */
+	bool solve(int numbers[9][9]);
+
+private:
+	int left[NODES];
+	int right[NODES];
+	int up[NODES];
+	int down[NODES];
+	int column[NODES];
+	int size[1 + COLUMNS];
+
+	int solution[81];
+
+	void cover(int c);
+	void uncover(int c);
+
+	/**
+	 * Covers (or uncovers, in reverse order) all the columns of the row starting at node r
+	 */
+	void select(int r);
+	void unselect(int r);
+
+	bool search(int depth, int &solutionSize);
+};
+
+#endif /* DANCINGLINKS_H_ */
@@ -4,74 +4,204 @@
  */
 
 #include "Sudoku.h"
+#include "DancingLinks.h"
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+template <int N>
+BasicSudoku<N>::Tables::Tables() {
+	for (int i = 0; i < SIZE; i++)
+		for (int j = 0; j < SIZE; j++)
+			block[i][j] = i / N * N + j / N;
+
+	for (int u = 0; u < SIZE; u++) {
+		for (int k = 0; k < SIZE; k++) {
+			unitLine[u][k] = u;
+			unitColumn[u][k] = k;
+			unitLine[SIZE + u][k] = k;
+			unitColumn[SIZE + u][k] = u;
+			unitLine[2 * SIZE + u][k] = u / N * N + k / N;
+			unitColumn[2 * SIZE + u][k] = u % N * N + k % N;
+		}
+	}
+}
+
+template <int N>
+const typename BasicSudoku<N>::Tables BasicSudoku<N>::tables;
 
 /** Inicia um Sudoku vazio.
  */
-Sudoku::Sudoku() {
+template <int N>
+BasicSudoku<N>::BasicSudoku() {
 	this->initialize();
 }
 
 /**
  * Inicia um Sudoku com um contedo inicial.
  * Lana excepo IllegalArgumentException se os valores
- * estiverem fora da gama de 1 a 9 ou se existirem nmeros repetidos
- * por linha, coluna ou bloc 3x3.
+ * estiverem fora da gama de 1 a SIZE ou se existirem nmeros repetidos
+ * por linha, coluna ou bloco.
  *
  * @param nums matriz com os valores iniciais (0 significa por preencher)
  */
-Sudoku::Sudoku(int nums[9][9]) {
+template <int N>
+BasicSudoku<N>::BasicSudoku(int nums[SIZE][SIZE]) {
 	this->initialize();
 
-	for (int i = 0; i < 9; i++) {
-		for (int j = 0; j < 9; j++) {
-			if (nums[i][j] != 0) {
-				int n = nums[i][j];
-				numbers[i][j] = n;
-				lineHasNumber[i][n] = true;
-				columnHasNumber[j][n] = true;
-				block3x3HasNumber[i / 3][j / 3][n] = true;
-				countFilled++;
-			}
+	for (int i = 0; i < SIZE; i++) {
+		for (int j = 0; j < SIZE; j++) {
+			if (nums[i][j] != 0)
+				setNumber(i, j, nums[i][j]);
 		}
 	}
 }
 
-void Sudoku::initialize() {
-	for (int i = 0; i < 9; i++) {
-		for (int j = 0; j < 9; j++) {
-			for (int n = 0; n < 10; n++) {
-				numbers[i][j] = 0;
-				lineHasNumber[i][n] = false;
-				columnHasNumber[j][n] = false;
-				block3x3HasNumber[i / 3][j / 3][n] = false;
+template <int N>
+void BasicSudoku<N>::initialize() {
+	for (int i = 0; i < SIZE; i++) {
+		for (int j = 0; j < SIZE; j++)
+			numbers[i][j] = 0;
+
+		lineMask[i] = 0;
+		columnMask[i] = 0;
+		blockMask[i] = 0;
+	}
+
+	this->countFilled = 0;
+	this->trailSize = 0;
+}
+
+template <int N>
+void BasicSudoku<N>::setNumber(int i, int j, int n) {
+	Mask bit = (Mask) 1 << n;
+
+	numbers[i][j] = n;
+	lineMask[i] |= bit;
+	columnMask[j] |= bit;
+	blockMask[tables.block[i][j]] |= bit;
+	countFilled++;
+}
+
+template <int N>
+void BasicSudoku<N>::clearNumber(int i, int j) {
+	Mask bit = (Mask) ~((Mask) 1 << numbers[i][j]);
+
+	numbers[i][j] = 0;
+	lineMask[i] &= bit;
+	columnMask[j] &= bit;
+	blockMask[tables.block[i][j]] &= bit;
+	countFilled--;
+}
+
+template <int N>
+void BasicSudoku<N>::assign(int i, int j, int n) {
+	setNumber(i, j, n);
+	trail[trailSize++] = i * SIZE + j;
+}
+
+template <int N>
+void BasicSudoku<N>::undo(int mark) {
+	while (trailSize > mark) {
+		int cell = trail[--trailSize];
+		clearNumber(cell / SIZE, cell % SIZE);
+	}
+}
+
+template <int N>
+bool BasicSudoku<N>::propagate() {
+	bool changed = true;
+
+	while (changed) {
+		changed = false;
+
+		for (int i = 0; i < SIZE; i++) {
+			for (int j = 0; j < SIZE; j++) {
+				if (numbers[i][j])
+					continue;
+
+				Mask possibilities = getPossibilities(i, j);
+				if (!possibilities)
+					return false;
+
+				if (!(possibilities & (possibilities - 1))) {
+					assign(i, j, __builtin_ctzll(possibilities));
+					changed = true;
+				}
+			}
+		}
+
+		// units 0 to SIZE - 1 are the lines, then the columns and then the blocks
+		for (int unit = 0; unit < 3 * SIZE; unit++) {
+			const unsigned char *lines = tables.unitLine[unit], *columns = tables.unitColumn[unit];
+			Mask once = 0, twice = 0;
+
+			for (int k = 0; k < SIZE; k++) {
+				Mask possibilities = getPossibilities(lines[k], columns[k]);
+				twice |= once & possibilities;
+				once |= possibilities;
+			}
+
+			Mask used = unit < SIZE ? lineMask[unit] : unit < 2 * SIZE ? columnMask[unit - SIZE]
+					: blockMask[unit - 2 * SIZE];
+
+			// some number has nowhere left to go in this unit
+			if ((once | used) != ALL_NUMBERS)
+				return false;
+
+			Mask singles = once & ~twice;
+
+			for (int k = 0; k < SIZE && singles; k++) {
+				int i = lines[k], j = columns[k];
+				Mask possibilities = getPossibilities(i, j) & singles;
+
+				if (!possibilities)
+					continue;
+
+				// two numbers that can only go in the same cell
+				if (possibilities & (possibilities - 1))
+					return false;
+
+				assign(i, j, __builtin_ctzll(possibilities));
+				singles &= ~possibilities;
+				changed = true;
 			}
 		}
 	}
 
-	this->countFilled = 0;
+	return true;
 }
 
 /**
  * Obtem o contedo actual (s para leitura!).
  */
-int **Sudoku::getNumbers() {
-	int **ret = new int *[9];
+template <int N>
+int **BasicSudoku<N>::getNumbers() {
+	int **ret = new int *[SIZE];
 
-	for (int i = 0; i < 9; i++) {
-		ret[i] = new int[9];
+	for (int i = 0; i < SIZE; i++) {
+		ret[i] = new int[SIZE];
 
-		for (int a = 0; a < 9; a++)
+		for (int a = 0; a < SIZE; a++)
 			ret[i][a] = numbers[i][a];
 	}
 
 	return ret;
 }
 
+template <int N>
+int BasicSudoku<N>::getNumber(int i, int j) const {
+	return numbers[i][j];
+}
+
 /**
  * Verifica se o Sudoku j est completamente resolvido
  */
-bool Sudoku::isComplete() {
-	return countFilled == 9 * 9;
+template <int N>
+bool BasicSudoku<N>::isComplete() {
+	return countFilled == CELLS;
 }
 
 
@@ -79,70 +209,260 @@ bool Sudoku::isComplete() {
  * Resolve o Sudoku.
  * Retorna indicao de sucesso ou insucesso (sudoku impossvel).
  */
-bool Sudoku::solve() {
-	std::set<int> possibilities;
-	std::pair<int, int> bestCell = getBestCell(possibilities); // coordinates, ie, X and Y
-
-	for (int n : possibilities) {
-		numbers[bestCell.first][bestCell.second] = n;
-		lineHasNumber[bestCell.first][n] = true;
-		columnHasNumber[bestCell.second][n] = true;
-		block3x3HasNumber[bestCell.first / 3][bestCell.second / 3][n] = true;
-		countFilled++;
-		if (solve()) {
-			return isComplete();
+template <int N>
+bool BasicSudoku<N>::solve(SudokuBackend backend) {
+	if (backend == DANCING_LINKS)
+		return solveDancingLinks();
+
+	return solveBacktracking();
+}
+
+template <int N>
+bool BasicSudoku<N>::solveBacktracking() {
+	int mark = trailSize;
+
+	// only branches once propagation stalls
+	if (propagate()) {
+		if (isComplete())
+			return true;
+
+		Mask possibilities;
+		std::pair<int, int> bestCell = getBestCell(possibilities); // coordinates, ie, X and Y
+		int branchMark = trailSize;
+
+		// tries the possibilities from the lowest number up, clearing each bit once tried
+		while (possibilities) {
+			int n = __builtin_ctzll(possibilities);
+			possibilities &= possibilities - 1;
+
+			assign(bestCell.first, bestCell.second, n);
+			if (solveBacktracking())
+				return true;
+			undo(branchMark);
+		}
+	}
+
+	undo(mark);
+	return false;
+}
+
+// the exact cover matrix is only built for 9x9 Sudokus
+template <int N>
+bool BasicSudoku<N>::solveDancingLinks() {
+	return solveBacktracking();
+}
+
+template <>
+bool BasicSudoku<3>::solveDancingLinks() {
+	// the matrix is built once per thread and restored after every solve
+	static thread_local DancingLinks dancingLinks;
+	int grid[9][9];
+
+	for (int i = 0; i < 9; i++)
+		for (int j = 0; j < 9; j++)
+			grid[i][j] = numbers[i][j];
+
+	if (!dancingLinks.solve(grid))
+		return false;
+
+	for (int i = 0; i < 9; i++)
+		for (int j = 0; j < 9; j++)
+			if (!numbers[i][j])
+				setNumber(i, j, grid[i][j]);
+
+	return true;
+}
+
+template <int N>
+void BasicSudoku<N>::countFrom(long long limit, atomic<long long> &count) {
+	int mark = trailSize;
+
+	if (propagate()) {
+		if (isComplete()) {
+			count++;
 		} else {
-			numbers[bestCell.first][bestCell.second] = 0;
-			lineHasNumber[bestCell.first][n] = false;
-			columnHasNumber[bestCell.second][n] = false;
-			block3x3HasNumber[bestCell.first / 3][bestCell.second / 3][n] = false;
-			countFilled--;
+			Mask possibilities;
+			std::pair<int, int> bestCell = getBestCell(possibilities);
+			int branchMark = trailSize;
+
+			while (possibilities && (limit <= 0 || count.load(memory_order_relaxed) < limit)) {
+				assign(bestCell.first, bestCell.second, __builtin_ctzll(possibilities));
+				possibilities &= possibilities - 1;
+
+				countFrom(limit, count);
+				undo(branchMark);
+			}
+		}
+	}
+
+	undo(mark);
+}
+
+/*
+ * Subtrees per worker the search is split into before counting, so stealing can even out uneven subtrees.
+ */
+static const int COUNT_TASKS_PER_THREAD = 16;
+
+/*
+ * A worker's own tasks: it takes from the back, idle workers steal from the front.
+ */
+template <int N>
+struct CountQueue {
+	mutex lock;
+	deque<BasicSudoku<N>> tasks;
+};
+
+template <int N>
+static bool takeTask(CountQueue<N> &queue, bool steal, BasicSudoku<N> &task) {
+	lock_guard<mutex> guard(queue.lock);
+
+	if (queue.tasks.empty())
+		return false;
+
+	if (steal) {
+		task = queue.tasks.front();
+		queue.tasks.pop_front();
+	} else {
+		task = queue.tasks.back();
+		queue.tasks.pop_back();
+	}
+	return true;
+}
+
+template <int N>
+long long BasicSudoku<N>::countSolutions(long long limit, int numThreads) const {
+	atomic<long long> count(0);
+	BasicSudoku root(*this);
+	root.trailSize = 0;
+
+	if (numThreads <= 1) {
+		root.countFrom(limit, count);
+		return count.load();
+	}
+
+	// expands the shallowest subtrees first until there are enough tasks, counting the solutions met on the way
+	deque<BasicSudoku> frontier;
+	frontier.push_back(root);
+
+	while (!frontier.empty() && (int) frontier.size() < COUNT_TASKS_PER_THREAD * numThreads) {
+		BasicSudoku node = frontier.front();
+		frontier.pop_front();
+
+		if (!node.propagate())
+			continue;
+
+		if (node.isComplete()) {
+			count++;
+			continue;
+		}
+
+		Mask possibilities;
+		std::pair<int, int> bestCell = node.getBestCell(possibilities);
+
+		while (possibilities) {
+			BasicSudoku child(node);
+			child.assign(bestCell.first, bestCell.second, __builtin_ctzll(possibilities));
+			possibilities &= possibilities - 1;
+			frontier.push_back(child);
+		}
+	}
+
+	vector<CountQueue<N>> queues(numThreads);
+	for (size_t t = 0; t < frontier.size(); t++)
+		queues[t % numThreads].tasks.push_back(frontier[t]);
+
+	// no task spawns others, so a worker is done once every queue is empty
+	auto worker = [&](int id) {
+		BasicSudoku task;
+
+		for (;;) {
+			bool found = takeTask(queues[id], false, task);
+			for (int k = 1; k < numThreads && !found; k++)
+				found = takeTask(queues[(id + k) % numThreads], true, task);
+
+			if (!found || (limit > 0 && count.load() >= limit))
+				return;
+
+			task.countFrom(limit, count);
 		}
+	};
+
+	vector<thread> workers;
+	for (int t = 1; t < numThreads; t++)
+		workers.push_back(thread(worker, t));
+	worker(0);
+
+	for (thread &w : workers)
+		w.join();
+
+	return limit > 0 ? min(count.load(), limit) : count.load();
+}
+
+template <int N>
+bool BasicSudoku<N>::removeClue(int i, int j) {
+	int n = numbers[i][j];
+	int mark = trailSize;
+	bool other = false;
+
+	clearNumber(i, j);
+
+	// any solution with another number here is a second solution
+	Mask others = getPossibilities(i, j) & (Mask) ~((Mask) 1 << n);
+	while (others && !other) {
+		assign(i, j, __builtin_ctzll(others));
+		others &= others - 1;
+
+		other = solveBacktracking();
+		undo(mark);
 	}
 
-	return isComplete();
+	if (other)
+		setNumber(i, j, n);
+
+	return !other;
 }
 
 /**
  * Imprime o Sudoku.
  */
-void Sudoku::print() {
-	for (int i = 0; i < 9; i++) {
-		for (int a = 0; a < 9; a++)
+template <int N>
+void BasicSudoku<N>::print() {
+	for (int i = 0; i < SIZE; i++) {
+		for (int a = 0; a < SIZE; a++)
 			cout << this->numbers[i][a] << " ";
 
 		cout << endl;
 	}
 }
 
-std::set<int> Sudoku::getPossibilities(int i, int j) {
-	set<int> a;
-
+template <int N>
+typename BasicSudoku<N>::Mask BasicSudoku<N>::getPossibilities(int i, int j) const {
 	if (numbers[i][j])
-		return a;
+		return 0;
 
-	for (int n = 1; n <= 9; n++)
-		if (!lineHasNumber[i][n] && !columnHasNumber[j][n] && !block3x3HasNumber[i / 3][j / 3][n])
-			a.insert(n);
-	return a;
+	return (Mask) (~(lineMask[i] | columnMask[j] | blockMask[tables.block[i][j]]) & ALL_NUMBERS);
 }
 
-std::pair<int, int> Sudoku::getBestCell(std::set<int> &possibilities) {
-	std::set<int> tmp;
+template <int N>
+std::pair<int, int> BasicSudoku<N>::getBestCell(Mask &possibilities) const {
 	std::pair<int, int> result = {0, 0};
-	int bestAmount = 10;
+	int bestAmount = SIZE + 1;
+
+	possibilities = 0;
 
-	for (int i = 0; i < 9; i++) {
-		for (int j = 0; j < 9; j++) {
+	for (int i = 0; i < SIZE; i++) {
+		for (int j = 0; j < SIZE; j++) {
 			if (!numbers[i][j]) {
-				tmp = getPossibilities(i, j);
+				Mask tmp = getPossibilities(i, j);
+				int amount = __builtin_popcountll(tmp);
 
-				if (tmp.size() < bestAmount) {
-					bestAmount = tmp.size();
-					possibilities = std::set<int>(tmp);
+				if (amount < bestAmount) {
+					bestAmount = amount;
+					possibilities = tmp;
 					result = {i, j};
 
-					if (bestAmount == 1)
+					// a dead end (no possibilities) or a forced cell cannot be beaten
+					if (bestAmount <= 1)
 						return result;
 				}
 			}
@@ -152,3 +472,8 @@ std::pair<int, int> Sudoku::getBestCell(std::set<int> &possibilities) {
 
 	return result;
 }
+
+template class BasicSudoku<3>;
+template class BasicSudoku<4>;
+template class BasicSudoku<5>;
+template class BasicSudoku<6>;
@@ -12,66 +12,158 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
-#include <set>
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
 
 using namespace std;
 
 #define IllegalArgumentException -1
 
-class Sudoku
+/**
+ * Algorithms available to solve a Sudoku: a most constrained cell first
+ * backtracking or an exact cover search with dancing links.
+ */
+enum SudokuBackend { BACKTRACKING, DANCING_LINKS };
+
+/**
+ * Sudoku of N*N x N*N cells, with N x N blocks (N from 3 to 6).
+ * A 9x9 Sudoku is BasicSudoku<3>, or simply Sudoku.
+ */
+template <int N>
+class BasicSudoku
 {
+public:
+	static const int SIZE = N * N;
+	static const int CELLS = SIZE * SIZE;
+
+	/**
+	 * Smallest unsigned integer with a bit for each number (bits 1 to SIZE, bit 0 unused)
+	 */
+	typedef typename conditional<(SIZE < 16), uint16_t,
+			typename conditional<(SIZE < 32), uint32_t, uint64_t>::type>::type Mask;
+
+private:
+	static const Mask ALL_NUMBERS = (Mask) (((Mask) 1 << (SIZE + 1)) - 2);
+
 	/**
-	 * numbers[i][j] - nmero que ocupa a linha i, coluna j (de 0 a 8)
+	 * Lookups shared by every Sudoku of this size, so the hot loops never divide by N.
+	 */
+	struct Tables {
+		int block[SIZE][SIZE];                    // block of the cell i, j, numbered line by line
+		unsigned char unitLine[3 * SIZE][SIZE];   // line and column of the k-th cell of each unit
+		unsigned char unitColumn[3 * SIZE][SIZE]; // (the lines, then the columns, then the blocks)
+		Tables();
+	};
+
+	static const Tables tables;
+
+	/**
+	 * numbers[i][j] - nmero que ocupa a linha i, coluna j (de 0 a SIZE - 1)
 	 * 0 quer dizer no preenchido.
 	 */
-	int numbers[9][9];
+	int numbers[SIZE][SIZE];
 
 	/**
-	 * Informao derivada da anterior, para acelerar processamento (nmero de 1 a 9, nao usa 0)
+	 * Informao derivada da anterior, para acelerar processamento (nmero de 1 a SIZE, nao usa 0)
 	 */
 	int countFilled;
-	bool columnHasNumber[9][10];
-	bool lineHasNumber[9][10];
-	bool block3x3HasNumber[3][3][10];
+
+	/**
+	 * Numbers already used by each column, line and block, as masks where
+	 * bit n is set when number n is present.
+	 */
+	Mask columnMask[SIZE];
+	Mask lineMask[SIZE];
+	Mask blockMask[SIZE];
+
+	/**
+	 * Cells filled while solving (as i * SIZE + j), in order, so a failed branch can be undone
+	 */
+	int trail[CELLS];
+	int trailSize;
 
 	/**
 	 * Gets the possible solutions for the cell in the position i, j
 	 * @param i
 	 * @param j
-	 * @return the possible solutions
+	 * @return the possible solutions, as a mask with bit n set when n fits (0 if the cell is filled)
 	 */
-	std::set<int> getPossibilities(int i, int j);
+	Mask getPossibilities(int i, int j) const;
 
 	void initialize();
 
 	/**
-	 * Gets the best cell to fill, "greedly", filling as well a set of possibilities to that cell.
+	 * Places n in the cell i, j, updating the masks.
+	 */
+	void setNumber(int i, int j, int n);
+
+	/**
+	 * Clears the cell i, j, updating the masks.
+	 */
+	void clearNumber(int i, int j);
+
+	/**
+	 * Places n in the cell i, j, recording it in the trail.
+	 */
+	void assign(int i, int j, int n);
+
+	/**
+	 * Clears the cells filled since the trail had the given size.
+	 */
+	void undo(int mark);
+
+	/**
+	 * Fills naked singles (cells with one possibility) and hidden singles (numbers
+	 * with one possible cell in a line, column or block) until none is left.
 	 *
-	 * @param possibilities the set of possibilities
+	 * @return false if a contradiction was found
+	 */
+	bool propagate();
+
+	/**
+	 * Gets the best cell to fill, "greedly", filling as well the possibilities of that cell.
+	 *
+	 * @param possibilities the mask of possibilities
 	 * @return the pair of the best cell {x, y}
 	 */
-	std::pair<int, int> getBestCell(std::set<int> &possibilities);
+	std::pair<int, int> getBestCell(Mask &possibilities) const;
+
+	bool solveBacktracking();
+
+	bool solveDancingLinks();
+
+	/**
+	 * Adds the solutions below the current grid to count, stopping once count reaches limit (if positive).
+	 * The grid is restored before returning.
+	 */
+	void countFrom(long long limit, std::atomic<long long> &count);
 
 public:
 	/** Inicia um Sudoku vazio.
 	 */
-	Sudoku();
+	BasicSudoku();
 
 	/**
 	 * Inicia um Sudoku com um contedo inicial.
 	 * Lana excepo IllegalArgumentException se os valores
-	 * estiverem fora da gama de 1 a 9 ou se existirem nmeros repetidos
-	 * por linha, coluna ou bloc 3x3.
+	 * estiverem fora da gama de 1 a SIZE ou se existirem nmeros repetidos
+	 * por linha, coluna ou bloco.
 	 *
 	 * @param nums matriz com os valores iniciais (0 significa por preencher)
 	 */
-	Sudoku(int nums[9][9]);
+	BasicSudoku(int nums[SIZE][SIZE]);
 
 	/**
 	 * Obtem o contedo actual (s para leitura!).
 	 */
 	int** getNumbers();
 
+	/**
+	 * Gets the number in the cell i, j (0 if empty), without copying the grid.
+	 */
+	int getNumber(int i, int j) const;
+
 
 	/**
 	 * Verifica se o Sudoku j est completamente resolvido
@@ -82,11 +174,34 @@ public:
 	/**
 	 * Resolve o Sudoku.
 	 * Retorna indicao de sucesso ou insucesso (sudoku impossvel).
+	 *
+	 * @param backend the algorithm used to search for the solution (dancing links only handles 9x9,
+	 * other sizes always backtrack)
 	 */
-	bool solve();
+	bool solve(SudokuBackend backend = BACKTRACKING);
 
 	bool solve2();
 
+	/**
+	 * Counts the solutions of the Sudoku, leaving it unchanged.
+	 * The search tree is split at shallow depth into tasks shared by numThreads workers,
+	 * which steal tasks from each other once their own run out.
+	 *
+	 * @param limit stops counting once limit solutions are found (2 checks uniqueness), 0 counts them all
+	 * @param numThreads number of worker threads
+	 * @return the number of solutions, at most limit
+	 */
+	long long countSolutions(long long limit = 2, int numThreads = 1) const;
+
+	/**
+	 * Empties the cell i, j if the Sudoku still has a single solution without it.
+	 * Only searches for a solution with another number in that cell, reusing the
+	 * current state, so the Sudoku must have a single solution before the call.
+	 *
+	 * @return true if the cell was emptied, false if its number was needed (and was kept)
+	 */
+	bool removeClue(int i, int j);
+
 
 	/**
 	 * Imprime o Sudoku.
@@ -94,4 +209,6 @@ public:
 	void print();
 };
 
+typedef BasicSudoku<3> Sudoku;
+
 #endif /* SUDOKU_H_ */
@@ -0,0 +1,192 @@
+/*
+ * SudokuBatch.cpp
+ */
+
+#include "SudokuBatch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+/*
+ * Puzzles a worker takes from the shared counter at a time, enough to keep the counter off the hot path.
+ */
+static const long long BATCH_CHUNK = 64;
+
+/*
+ * Every solution takes 81 digits and a newline in the output buffer.
+ */
+static const int SOLUTION_LENGTH = 82;
+
+
+bool parsePuzzle(const char *line, int numbers[9][9]) {
+	for (int k = 0; k < 81; k++) {
+		char c = line[k];
+
+		if (c >= '1' && c <= '9')
+			numbers[k / 9][k % 9] = c - '0';
+		else if (c == '0' || c == '.')
+			numbers[k / 9][k % 9] = 0;
+		else
+			return false;
+	}
+
+	return true;
+}
+
+static void solveRange(const char *data, const vector<size_t> &starts, const vector<size_t> &lengths,
+		atomic<long long> &next, SudokuBackend backend, char *solutions, char *solved, long long *latencies) {
+	long long numPuzzles = starts.size();
+	int numbers[9][9];
+
+	for (long long first = next.fetch_add(BATCH_CHUNK); first < numPuzzles; first = next.fetch_add(BATCH_CHUNK)) {
+		long long last = min(first + BATCH_CHUNK, numPuzzles);
+
+		for (long long p = first; p < last; p++) {
+			auto begin = chrono::steady_clock::now();
+
+			solved[p] = 0;
+			if (lengths[p] == 81 && parsePuzzle(data + starts[p], numbers)) {
+				Sudoku sudoku(numbers);
+
+				if (sudoku.solve(backend)) {
+					char *solution = solutions + p * SOLUTION_LENGTH;
+					for (int k = 0; k < 81; k++)
+						solution[k] = (char) ('0' + sudoku.getNumber(k / 9, k % 9));
+					solution[81] = '\n';
+					solved[p] = 1;
+				}
+			}
+
+			latencies[p] = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - begin).count();
+		}
+	}
+}
+
+// microseconds at the given fraction of the sorted latencies, reordering them partially
+static double latencyPercentile(vector<long long> &latencies, double fraction) {
+	size_t k = (size_t) (fraction * (latencies.size() - 1));
+	nth_element(latencies.begin(), latencies.begin() + k, latencies.end());
+	return latencies[k] / 1e3;
+}
+
+bool solveBatch(const char *data, size_t size, FILE *out, int numThreads, SudokuBackend backend, BatchResult &result) {
+	auto begin = chrono::steady_clock::now();
+
+	// indexes the lines up front, so the workers only touch the puzzles they take
+	size_t numLines = 0;
+	for (const char *p = data; p < data + size; p++)
+		numLines += *p == '\n';
+
+	vector<size_t> starts, lengths;
+	starts.reserve(numLines + 1);
+	lengths.reserve(numLines + 1);
+
+	for (size_t pos = 0; pos < size;) {
+		const char *end = (const char *) memchr(data + pos, '\n', size - pos);
+		size_t lineEnd = end ? end - data : size;
+		size_t length = lineEnd - pos;
+
+		if (length > 0 && data[lineEnd - 1] == '\r')
+			length--;
+
+		if (length > 0) {
+			starts.push_back(pos);
+			lengths.push_back(length);
+		}
+
+		pos = lineEnd + 1;
+	}
+
+	long long numPuzzles = starts.size();
+	vector<char> solutions(numPuzzles * SOLUTION_LENGTH);
+	vector<char> solved(numPuzzles);
+	vector<long long> latencies(numPuzzles);
+	atomic<long long> next(0);
+
+	numThreads = max(1, numThreads);
+	vector<thread> workers;
+	for (int t = 1; t < numThreads; t++)
+		workers.push_back(thread(solveRange, data, cref(starts), cref(lengths), ref(next), backend,
+				solutions.data(), solved.data(), latencies.data()));
+	solveRange(data, starts, lengths, next, backend, solutions.data(), solved.data(), latencies.data());
+
+	for (thread &worker : workers)
+		worker.join();
+
+	bool written = true;
+	result.solved = 0;
+
+	for (long long p = 0; p < numPuzzles && written; p++) {
+		if (solved[p]) {
+			written = fwrite(solutions.data() + p * SOLUTION_LENGTH, 1, SOLUTION_LENGTH, out) == SOLUTION_LENGTH;
+			result.solved++;
+		} else {
+			written = fputs("-\n", out) >= 0;
+		}
+	}
+
+	result.puzzles = numPuzzles;
+	result.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	result.puzzlesPerSecond = result.seconds > 0 ? numPuzzles / result.seconds : 0;
+
+	if (numPuzzles == 0) {
+		result.latencyP50 = result.latencyP90 = result.latencyP99 = result.latencyMax = 0;
+	} else {
+		result.latencyP50 = latencyPercentile(latencies, 0.5);
+		result.latencyP90 = latencyPercentile(latencies, 0.9);
+		result.latencyP99 = latencyPercentile(latencies, 0.99);
+		result.latencyMax = latencyPercentile(latencies, 1);
+	}
+
+	return written;
+}
+
+bool solveBatchFile(const string &inPath, const string &outPath, int numThreads, SudokuBackend backend,
+		BatchResult &result) {
+	int fd = open(inPath.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		return false;
+	}
+
+	size_t size = info.st_size;
+	const char *data = "";
+	void *mapped = MAP_FAILED;
+
+	// mmap refuses empty files, which simply have no puzzles
+	if (size > 0) {
+		mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapped == MAP_FAILED) {
+			close(fd);
+			return false;
+		}
+		madvise(mapped, size, MADV_SEQUENTIAL);
+		data = (const char *) mapped;
+	}
+	close(fd);
+
+	FILE *out = outPath == "-" ? stdout : fopen(outPath.c_str(), "wb");
+	bool success = out != nullptr && solveBatch(data, size, out, numThreads, backend, result);
+
+	if (out != nullptr && out != stdout)
+		success = fclose(out) == 0 && success;
+	if (mapped != MAP_FAILED)
+		munmap(mapped, size);
+
+	return success;
+}
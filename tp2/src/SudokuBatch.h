@@ -0,0 +1,52 @@
+/*
+ * SudokuBatch.h
+ *
+ */
+
+#ifndef SUDOKUBATCH_H_
+#define SUDOKUBATCH_H_
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+
+#include "Sudoku.h"
+
+/**
+ * Throughput and per puzzle latency of a batch run (latencies in microseconds).
+ */
+struct BatchResult {
+	long long puzzles;
+	long long solved;
+	double seconds;
+	double puzzlesPerSecond;
+	double latencyP50;
+	double latencyP90;
+	double latencyP99;
+	double latencyMax;
+};
+
+/**
+ * Reads a puzzle written as 81 characters, line by line: '1' to '9' are clues, '0' or '.' empty cells.
+ *
+ * @return false if some character is not valid
+ */
+bool parsePuzzle(const char *line, int numbers[9][9]);
+
+/**
+ * Solves every puzzle in data, one per line (blank lines are skipped), spreading them over numThreads workers.
+ * The solutions are written to out in the input order, as 81 digit lines, or "-" for invalid or impossible puzzles.
+ *
+ * @return false if writing failed
+ */
+bool solveBatch(const char *data, size_t size, FILE *out, int numThreads, SudokuBackend backend, BatchResult &result);
+
+/**
+ * Same as solveBatch, mapping the puzzles file into memory. outPath "-" writes to the standard output.
+ *
+ * @return false if a file could not be opened, mapped or written
+ */
+bool solveBatchFile(const std::string &inPath, const std::string &outPath, int numThreads, SudokuBackend backend,
+		BatchResult &result);
+
+#endif /* SUDOKUBATCH_H_ */
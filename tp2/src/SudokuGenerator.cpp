@@ -0,0 +1,90 @@
+/*
+ * SudokuGenerator.cpp
+ */
+
+#include "SudokuGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+// a full grid: the three diagonal blocks don't share lines or columns, so they can be shuffled independently
+// before solving fills the rest
+static void randomGrid(mt19937 &random, int grid[9][9]) {
+	int digits[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+	for (int i = 0; i < 9; i++)
+		for (int j = 0; j < 9; j++)
+			grid[i][j] = 0;
+
+	for (int b = 0; b < 3; b++) {
+		shuffle(digits, digits + 9, random);
+		for (int k = 0; k < 9; k++)
+			grid[b * 3 + k / 3][b * 3 + k % 3] = digits[k];
+	}
+
+	Sudoku sudoku(grid);
+	sudoku.solve();
+
+	for (int i = 0; i < 9; i++)
+		for (int j = 0; j < 9; j++)
+			grid[i][j] = sudoku.getNumber(i, j);
+}
+
+GeneratedPuzzle generatePuzzle(unsigned seed, int targetClues, double seconds) {
+	auto deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(
+			chrono::duration<double>(seconds));
+	mt19937 random(seed);
+	GeneratedPuzzle best;
+	best.clues = 82;
+
+	int cells[81];
+	for (int k = 0; k < 81; k++)
+		cells[k] = k;
+
+	do {
+		int grid[9][9];
+		randomGrid(random, grid);
+		shuffle(cells, cells + 81, random);
+
+		// the same Sudoku is kept through the removals, each check only searching from its current state
+		Sudoku puzzle(grid);
+		int clues = 81;
+
+		for (int k = 0; k < 81 && clues > targetClues; k++)
+			if (puzzle.removeClue(cells[k] / 9, cells[k] % 9))
+				clues--;
+
+		if (clues < best.clues) {
+			best.clues = clues;
+			for (int i = 0; i < 9; i++)
+				for (int j = 0; j < 9; j++)
+					best.numbers[i][j] = puzzle.getNumber(i, j);
+		}
+	} while (best.clues > targetClues && chrono::steady_clock::now() < deadline);
+
+	return best;
+}
+
+void generatePuzzles(int numPuzzles, unsigned seed, int targetClues, double seconds, int numThreads,
+		vector<GeneratedPuzzle> &puzzles) {
+	atomic<int> next(0);
+	puzzles.resize(max(0, numPuzzles));
+
+	auto worker = [&]() {
+		for (int p = next++; p < numPuzzles; p = next++)
+			puzzles[p] = generatePuzzle(seed + p, targetClues, seconds);
+	};
+
+	vector<thread> workers;
+	for (int t = 1; t < numThreads; t++)
+		workers.push_back(thread(worker));
+	worker();
+
+	for (thread &w : workers)
+		w.join();
+}
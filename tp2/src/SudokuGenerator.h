@@ -0,0 +1,42 @@
+/*
+ * SudokuGenerator.h
+ *
+ */
+
+#ifndef SUDOKUGENERATOR_H_
+#define SUDOKUGENERATOR_H_
+
+#include <vector>
+
+#include "Sudoku.h"
+
+/**
+ * A 9x9 puzzle with a single solution.
+ */
+struct GeneratedPuzzle {
+	int numbers[9][9];
+	int clues;
+};
+
+/**
+ * Generates a puzzle with a single solution and as few clues as possible.
+ * Starts from a random full grid and empties its cells in random order, keeping each clue only if it is needed
+ * for the solution to stay unique. Tries new grids until the puzzle has at most targetClues clues or the time
+ * budget runs out, and returns the puzzle with the fewest clues found (always at least one full attempt).
+ *
+ * @param seed seed of the random grids and removal orders
+ * @param targetClues number of clues from which the search stops
+ * @param seconds time budget
+ */
+GeneratedPuzzle generatePuzzle(unsigned seed, int targetClues, double seconds);
+
+/**
+ * Generates numPuzzles puzzles as generatePuzzle, with the seeds seed, seed + 1, ..., spread over numThreads workers.
+ *
+ * @param seconds time budget of each puzzle
+ * @param puzzles the puzzles, in seed order
+ */
+void generatePuzzles(int numPuzzles, unsigned seed, int targetClues, double seconds, int numThreads,
+		std::vector<GeneratedPuzzle> &puzzles);
+
+#endif /* SUDOKUGENERATOR_H_ */
@@ -11,6 +11,8 @@
 
 #include "../src/Sudoku.h"
 #include "../src/Labirinth.h"
+#include "../src/SudokuBatch.h"
+#include "../src/SudokuGenerator.h"
 
 using namespace std;
 using testing::Eq;
@@ -267,6 +269,387 @@ TEST(CAL_FP02, testSudokuImpossible) {
 }
 
 
+TEST(CAL_FP02, testSudokuPropagationOnly) {
+    // naked singles alone stall on this one, hidden singles fill the rest without any guess
+    int in[9][9] =
+            {{0, 0, 0, 0, 4, 0, 7, 9, 5},
+             {1, 0, 4, 0, 0, 6, 0, 0, 0},
+             {0, 3, 0, 0, 0, 0, 0, 0, 0},
+             {5, 0, 0, 1, 0, 0, 0, 0, 4},
+             {2, 0, 0, 0, 9, 4, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 8, 0, 1},
+             {0, 2, 3, 0, 0, 0, 5, 0, 0},
+             {0, 0, 0, 0, 1, 9, 0, 0, 0},
+             {4, 0, 0, 6, 0, 0, 0, 0, 0}};
+
+    int out[9][9] =
+            {{8, 6, 2, 3, 4, 1, 7, 9, 5},
+             {1, 5, 4, 9, 7, 6, 3, 8, 2},
+             {9, 3, 7, 8, 2, 5, 1, 4, 6},
+             {5, 7, 6, 1, 3, 8, 9, 2, 4},
+             {2, 1, 8, 5, 9, 4, 6, 3, 7},
+             {3, 4, 9, 7, 6, 2, 8, 5, 1},
+             {6, 2, 3, 4, 8, 7, 5, 1, 9},
+             {7, 8, 5, 2, 1, 9, 4, 6, 3},
+             {4, 9, 1, 6, 5, 3, 2, 7, 8}};
+
+    Sudoku s(in);
+    EXPECT_EQ(s.countSolutions(), 1);
+    EXPECT_EQ(s.solve(), true);
+
+    int sout[9][9];
+    for (int i = 0; i < 9; i++)
+        for (int a = 0; a < 9; a++)
+            sout[i][a] = s.getNumber(i, a);
+
+    compareSudokus(out, sout);
+}
+
+
+TEST(CAL_FP02, testSudokuContradictions) {
+    // the first cell has no possibility left
+    int noCandidates[9][9] =
+            {{0, 1, 2, 3, 4, 5, 6, 7, 8},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {9, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0}};
+
+    // every cell has possibilities, but 1 has no place left in the first line
+    int noPlace[9][9] =
+            {{0, 0, 0, 2, 3, 4, 5, 6, 7},
+             {1, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0}};
+
+    Sudoku s1(noCandidates);
+    EXPECT_EQ(s1.solve(), false);
+    EXPECT_EQ(s1.countSolutions(), 0);
+
+    Sudoku s2(noPlace);
+    EXPECT_EQ(s2.solve(), false);
+    EXPECT_EQ(s2.countSolutions(), 0);
+
+    int out[9][9];
+    for (int i = 0; i < 9; i++)
+        for (int a = 0; a < 9; a++)
+            out[i][a] = s1.getNumber(i, a);
+    compareSudokus(noCandidates, out);
+
+    for (int i = 0; i < 9; i++)
+        for (int a = 0; a < 9; a++)
+            out[i][a] = s2.getNumber(i, a);
+    compareSudokus(noPlace, out);
+}
+
+
+TEST(CAL_FP02, testSudokuFailedSolveRestores) {
+    // only fails deep in the search, after many cells were filled and undone
+    int in[9][9] =
+            {{7, 0, 0, 1, 0, 8, 0, 0, 0},
+             {4, 9, 0, 0, 0, 0, 0, 3, 2},
+             {0, 0, 0, 0, 0, 5, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 1, 0, 0},
+             {9, 6, 0, 0, 2, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 8, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 5, 0, 0, 1, 0, 0, 0},
+             {3, 2, 0, 0, 0, 0, 0, 0, 6}};
+
+    Sudoku failed(in);
+    Sudoku fresh(in);
+
+    for (int round = 0; round < 2; round++)
+    {
+        EXPECT_EQ(failed.solve(), false);
+        EXPECT_EQ(failed.isComplete(), false);
+
+        int out[9][9];
+        for (int i = 0; i < 9; i++)
+            for (int a = 0; a < 9; a++)
+                out[i][a] = failed.getNumber(i, a);
+        compareSudokus(in, out);
+    }
+
+    // removeClue searches from the current masks and trail, so any leftover from the failed
+    // solve would change its answer: without the wrong 4 the puzzle has a single solution
+    EXPECT_EQ(failed.removeClue(1, 0), fresh.removeClue(1, 0));
+    EXPECT_EQ(failed.removeClue(1, 0), false);
+
+    for (int i = 0; i < 9; i++)
+        for (int a = 0; a < 9; a++)
+            EXPECT_EQ(failed.getNumber(i, a), fresh.getNumber(i, a));
+}
+
+
+template <int N>
+void expectValidSolution(int in[N * N][N * N], const BasicSudoku<N> &s)
+{
+    const int SIZE = N * N;
+
+    for (int i = 0; i < SIZE; i++)
+    {
+        for (int j = 0; j < SIZE; j++)
+        {
+            if (in[i][j] != 0)
+            {
+                ASSERT_EQ(in[i][j], s.getNumber(i, j));
+            }
+
+            for (int k = 0; k < SIZE; k++)
+            {
+                if (k != j)
+                {
+                    ASSERT_NE(s.getNumber(i, j), s.getNumber(i, k));
+                }
+                if (k != i)
+                {
+                    ASSERT_NE(s.getNumber(i, j), s.getNumber(k, j));
+                }
+                int bi = i / N * N + k / N, bj = j / N * N + k % N;
+                if (bi != i || bj != j)
+                {
+                    ASSERT_NE(s.getNumber(i, j), s.getNumber(bi, bj));
+                }
+            }
+        }
+    }
+}
+
+
+TEST(CAL_FP02, testSudokuHard) {
+    int in[9][9] =
+            {{8, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 3, 6, 0, 0, 0, 0, 0},
+             {0, 7, 0, 0, 9, 0, 2, 0, 0},
+             {0, 5, 0, 0, 0, 7, 0, 0, 0},
+             {0, 0, 0, 0, 4, 5, 7, 0, 0},
+             {0, 0, 0, 1, 0, 0, 0, 3, 0},
+             {0, 0, 1, 0, 0, 0, 0, 6, 8},
+             {0, 0, 8, 5, 0, 0, 0, 1, 0},
+             {0, 9, 0, 0, 0, 0, 4, 0, 0}};
+
+    Sudoku s(in);
+    EXPECT_EQ(s.solve(), true);
+    EXPECT_EQ(s.isComplete(), true);
+    expectValidSolution(in, s);
+}
+
+TEST(CAL_FP02, testSudokuDancingLinks) {
+    int hard[9][9] =
+            {{8, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 3, 6, 0, 0, 0, 0, 0},
+             {0, 7, 0, 0, 9, 0, 2, 0, 0},
+             {0, 5, 0, 0, 0, 7, 0, 0, 0},
+             {0, 0, 0, 0, 4, 5, 7, 0, 0},
+             {0, 0, 0, 1, 0, 0, 0, 3, 0},
+             {0, 0, 1, 0, 0, 0, 0, 6, 8},
+             {0, 0, 8, 5, 0, 0, 0, 1, 0},
+             {0, 9, 0, 0, 0, 0, 4, 0, 0}};
+
+    int clash[9][9] =
+            {{7, 0, 0, 1, 0, 8, 0, 0, 7},
+             {0, 9, 0, 0, 0, 0, 0, 3, 2},
+             {0, 0, 0, 0, 0, 5, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 1, 0, 0},
+             {9, 6, 0, 0, 2, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 8, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 5, 0, 0, 1, 0, 0, 0},
+             {3, 2, 0, 0, 0, 0, 0, 0, 6}};
+
+    int impossible[9][9] =
+            {{7, 0, 0, 1, 0, 8, 0, 0, 0},
+             {4, 9, 0, 0, 0, 0, 0, 3, 2},
+             {0, 0, 0, 0, 0, 5, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 1, 0, 0},
+             {9, 6, 0, 0, 2, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 8, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 5, 0, 0, 1, 0, 0, 0},
+             {3, 2, 0, 0, 0, 0, 0, 0, 6}};
+
+    int empty[9][9] = {};
+
+    // the same solver instance is reused, so failures must leave it clean too
+    for (int round = 0; round < 2; round++)
+    {
+        Sudoku s1(hard);
+        EXPECT_EQ(s1.solve(DANCING_LINKS), true);
+        EXPECT_EQ(s1.isComplete(), true);
+        expectValidSolution(hard, s1);
+
+        Sudoku s2(clash);
+        EXPECT_EQ(s2.solve(DANCING_LINKS), false);
+
+        Sudoku s3(impossible);
+        EXPECT_EQ(s3.solve(DANCING_LINKS), false);
+        EXPECT_EQ(s3.isComplete(), false);
+
+        Sudoku s4(empty);
+        EXPECT_EQ(s4.solve(DANCING_LINKS), true);
+        expectValidSolution(empty, s4);
+    }
+}
+
+TEST(CAL_FP02, testSudokuCountSolutions) {
+    int minimal[9][9] =
+            {{7, 0, 0, 1, 0, 8, 0, 0, 0},
+             {0, 9, 0, 0, 0, 0, 0, 3, 2},
+             {0, 0, 0, 0, 0, 5, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 1, 0, 0},
+             {9, 6, 0, 0, 2, 0, 0, 0, 0},
+             {0, 0, 0, 0, 0, 0, 8, 0, 0},
+             {0, 0, 0, 0, 0, 0, 0, 0, 0},
+             {0, 0, 5, 0, 0, 1, 0, 0, 0},
+             {3, 2, 0, 0, 0, 0, 0, 0, 6}};
+
+    for (int numThreads = 1; numThreads <= 4; numThreads++)
+    {
+        Sudoku unique(minimal);
+        EXPECT_EQ(unique.countSolutions(2, numThreads), 1);
+        EXPECT_EQ(unique.countSolutions(0, numThreads), 1);
+        EXPECT_EQ(unique.isComplete(), false);
+
+        minimal[0][0] = 0;
+        Sudoku multiple(minimal);
+        EXPECT_EQ(multiple.countSolutions(2, numThreads), 2);
+        EXPECT_EQ(multiple.countSolutions(0, numThreads), 1130);
+
+        minimal[8][8] = 0;
+        Sudoku sparse(minimal);
+        EXPECT_EQ(sparse.countSolutions(1000, numThreads), 1000);
+
+        minimal[0][0] = 7;
+        minimal[1][0] = 4;
+        minimal[8][8] = 6;
+        Sudoku impossible(minimal);
+        EXPECT_EQ(impossible.countSolutions(2, numThreads), 0);
+        minimal[1][0] = 0;
+    }
+}
+
+TEST(CAL_FP02, testSudokuBatch) {
+    string hard = "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..";
+    string clash = "7..1.8..7.9.....32.....5.........1..96..2..........8.............5..1...32......6";
+    string impossible = "7..1.8...49.....32.....5.........1..96..2..........8.............5..1...32......6";
+    string input = hard + "\r\n" + clash + "\n\n" + impossible + "\n" + hard.substr(0, 80) + "\n" + hard;
+
+    int numbers[9][9];
+    EXPECT_EQ(parsePuzzle(hard.c_str(), numbers), true);
+    EXPECT_EQ(numbers[0][0], 8);
+    EXPECT_EQ(numbers[1][2], 3);
+    EXPECT_EQ(numbers[0][1], 0);
+    EXPECT_EQ(parsePuzzle("x", numbers), false);
+
+    Sudoku s(numbers);
+    s.solve();
+    string solution;
+    for (int k = 0; k < 81; k++)
+        solution += (char) ('0' + s.getNumber(k / 9, k % 9));
+
+    for (int numThreads = 1; numThreads <= 3; numThreads++)
+    {
+        FILE *out = tmpfile();
+        ASSERT_NE(out, nullptr);
+
+        BatchResult result;
+        EXPECT_EQ(solveBatch(input.c_str(), input.size(), out, numThreads, DANCING_LINKS, result), true);
+        EXPECT_EQ(result.puzzles, 5);
+        EXPECT_EQ(result.solved, 2);
+        EXPECT_LE(result.latencyP50, result.latencyMax);
+
+        // the blank line is skipped, the short line and the unsolvable ones are reported in place
+        char buffer[512] = {};
+        rewind(out);
+        fread(buffer, 1, sizeof(buffer) - 1, out);
+        fclose(out);
+        EXPECT_EQ(string(buffer), solution + "\n-\n-\n-\n" + solution + "\n");
+    }
+}
+
+
+template <int N>
+void expectSolvesLargeSudoku()
+{
+    const int SIZE = N * N;
+    int in[SIZE][SIZE];
+
+    // a valid full grid with roughly a third of its cells emptied
+    srand(N);
+    for (int i = 0; i < SIZE; i++)
+        for (int j = 0; j < SIZE; j++)
+            in[i][j] = rand() % 3 != 0 ? (N * (i % N) + i / N + j) % SIZE + 1 : 0;
+
+    BasicSudoku<N> s(in);
+    EXPECT_EQ(s.solve(), true);
+    EXPECT_EQ(s.isComplete(), true);
+    expectValidSolution(in, s);
+}
+
+
+TEST(CAL_FP02, testSudokuLarger) {
+    expectSolvesLargeSudoku<4>();
+    expectSolvesLargeSudoku<5>();
+    expectSolvesLargeSudoku<6>();
+
+    int empty[16][16] = {};
+    BasicSudoku<4> s(empty);
+    EXPECT_EQ(s.countSolutions(2, 2), 2);
+    EXPECT_EQ(s.solve(DANCING_LINKS), true);
+    EXPECT_EQ(s.isComplete(), true);
+}
+
+
+TEST(CAL_FP02, testSudokuGenerator) {
+    // an unreachable target with no time budget makes a single pass over a grid per puzzle
+    vector<GeneratedPuzzle> puzzles;
+    generatePuzzles(3, 42, 0, 0, 2, puzzles);
+    ASSERT_EQ(puzzles.size(), 3u);
+
+    for (GeneratedPuzzle &puzzle : puzzles)
+    {
+        int clues = 0;
+        for (int i = 0; i < 9; i++)
+            for (int j = 0; j < 9; j++)
+                clues += puzzle.numbers[i][j] != 0;
+        EXPECT_EQ(puzzle.clues, clues);
+        EXPECT_LT(clues, 30);
+
+        Sudoku s(puzzle.numbers);
+        EXPECT_EQ(s.countSolutions(2), 1);
+
+        // every clue left is needed
+        for (int i = 0; i < 9; i++)
+        {
+            for (int j = 0; j < 9; j++)
+            {
+                int n = puzzle.numbers[i][j];
+                if (n == 0)
+                    continue;
+
+                puzzle.numbers[i][j] = 0;
+                Sudoku relaxed(puzzle.numbers);
+                EXPECT_EQ(relaxed.countSolutions(2), 2);
+                puzzle.numbers[i][j] = n;
+            }
+        }
+    }
+
+    // removal stops as soon as the target is reached
+    GeneratedPuzzle easy = generatePuzzle(7, 40, 10);
+    EXPECT_EQ(easy.clues, 40);
+}
+
 TEST(CAL_FP02, testLabirinth) {
     int lab1[10][10] ={
             {0,0,0,0,0,0,0,0,0,0},